@@ -25,18 +25,29 @@
 //     that's not monitored because the max count was reached, enable monitoring
 //     on it if possible.
 
-const int logQueueSize = 16;
 const int logQueueAlignment = 64;
+const int logBatchSize = 64;
 
-LoggingThread::LoggingThread()
+LoggingThread::LoggingThread(int queueSize, UMApplicationMonitor::LoggingQueuePolicy policy)
     : m_loggerCount(0)
     , m_refCount(1)
-    , m_queueIndex(0)
-    , m_queueSize(0)
+    , m_waiting(0)
+    , m_queuePolicy(policy)
+    , m_threadId(0)
+    , m_queueMask(queueSize - 1)
     , m_flags(0)
+    , m_enqueuePosition(0)
+    , m_dequeuePosition(0)
 {
-    m_queue = static_cast<UMEvent*>(
-        alignedAlloc(logQueueAlignment, logQueueSize * sizeof(UMEvent)));
+    DASSERT(queueSize >= UMApplicationMonitorPrivate::minLoggingQueueSize);
+    DASSERT(queueSize <= UMApplicationMonitorPrivate::maxLoggingQueueSize);
+    DASSERT(IS_POWER_OF_TWO(queueSize));
+
+    m_queue = static_cast<QueueSlot*>(
+        alignedAlloc(logQueueAlignment, queueSize * sizeof(QueueSlot)));
+    for (int i = 0; i < queueSize; ++i) {
+        m_queue[i].sequence.store(i);
+    }
 
 #if !defined(QT_NO_DEBUG)
     setObjectName(QStringLiteral("UbuntuMetrics logging"));  // Thread name.
@@ -48,53 +59,130 @@ LoggingThread::~LoggingThread()
 {
     m_mutex.lock();
     m_flags |= JoinRequested;
-    if (m_flags & Waiting) {
-        m_condition.wakeOne();
-    }
+    m_condition.wakeOne();
     m_mutex.unlock();
     wait();
 
     free(m_queue);
 }
 
-#define BREAK_ON_JOIN_REQUEST()                \
-    if (Q_UNLIKELY(m_flags & JoinRequested)) { \
-        m_mutex.unlock();                      \
-        break;                                 \
+bool LoggingThread::enqueue(const UMEvent* event)
+{
+    // Claim the slot at the enqueue position. Its sequence number equals the
+    // position when it's free, and lags behind by the queue size when the
+    // queue is full.
+    QueueSlot* slot;
+    quint32 position = m_enqueuePosition.load();
+    while (true) {
+        slot = &m_queue[position & m_queueMask];
+        const qint32 difference = static_cast<qint32>(slot->sequence.loadAcquire() - position);
+        if (difference == 0) {
+            if (m_enqueuePosition.testAndSetRelaxed(position, position + 1)) {
+                break;
+            }
+            position = m_enqueuePosition.load();
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = m_enqueuePosition.load();
+        }
+    }
+
+    memcpy(&slot->event, event, sizeof(UMEvent));
+    slot->sequence.storeRelease(position + 1);
+    return true;
+}
+
+bool LoggingThread::dequeue(UMEvent* event)
+{
+    // The logging thread is the only regular consumer but producers can also
+    // dequeue with the DropOldest policy, so the position has to be claimed
+    // atomically too.
+    QueueSlot* slot;
+    quint32 position = m_dequeuePosition.load();
+    while (true) {
+        slot = &m_queue[position & m_queueMask];
+        const qint32 difference =
+            static_cast<qint32>(slot->sequence.loadAcquire() - (position + 1));
+        if (difference == 0) {
+            if (m_dequeuePosition.testAndSetRelaxed(position, position + 1)) {
+                break;
+            }
+            position = m_dequeuePosition.load();
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = m_dequeuePosition.load();
+        }
     }
 
+    memcpy(event, &slot->event, sizeof(UMEvent));
+    slot->sequence.storeRelease(position + m_queueMask + 1);
+    return true;
+}
+
+bool LoggingThread::isQueueEmpty() const
+{
+    const quint32 position = m_dequeuePosition.load();
+    return m_queue[position & m_queueMask].sequence.loadAcquire() != position + 1;
+}
+
 // Logging thread entry point.
 void LoggingThread::run()
 {
     DLOG("Entering logging thread.");
+    m_threadId.store(UMEventUtils::currentThreadId());
+    alignas(logQueueAlignment) UMEvent batch[logBatchSize];
     while (true) {
-        // Wait for new events in the log queue.
-        m_mutex.lock();
-        DASSERT(m_queueSize >= 0);
-        if (m_queueSize == 0) {
-            BREAK_ON_JOIN_REQUEST();
-            m_flags |= Waiting;
-            m_condition.wait(&m_mutex);
-            if (m_queueSize == 0) {
-                BREAK_ON_JOIN_REQUEST();
+        // Unqueue all the events available in the log queue and log them as
+        // a batch, that way the loggers are copied once per batch and the
+        // loggers can reduce the number of writes.
+        int eventCount = 0;
+        while (eventCount < logBatchSize && dequeue(&batch[eventCount])) {
+            eventCount++;
+        }
+        if (eventCount > 0) {
+            m_mutex.lock();
+            const int loggerCount = m_loggerCount;
+            UMLogger* loggers[UMApplicationMonitorPrivate::maxLoggers];
+            memcpy(loggers, m_loggers, loggerCount * sizeof(UMLogger*));
+            m_mutex.unlock();
+            for (int i = 0; i < loggerCount; ++i) {
+                loggers[i]->logBatch(batch, eventCount);
             }
-            m_flags &= ~Waiting;
+            continue;
         }
 
-        // Unqueue oldest events from the log queue.
-        DASSERT(m_queueSize > 0);
-        UMEvent event;
-        memcpy(&event, &m_queue[m_queueIndex], sizeof(UMEvent));
-        m_queueIndex = (m_queueIndex + 1) % logQueueSize;
-        m_queueSize--;
-
-        // Log.
-        const int loggerCount = m_loggerCount;
+        // Wait for new events in the log queue. The waiting state is set with
+        // a read-modify-write before checking the queue again. push() reads it
+        // with a read-modify-write too, after publishing its event. Both
+        // operate on the same atomic so they are totally ordered: either push()
+        // comes second, sees the waiting state and wakes us up (it has to take
+        // the mutex to do so), or it comes first and this acquire makes its
+        // event visible to the check.
+        m_mutex.lock();
+        m_waiting.fetchAndStoreOrdered(1);
+        if (isQueueEmpty()) {
+            if (Q_UNLIKELY(m_flags & JoinRequested)) {
+                m_waiting.store(0);
+                m_mutex.unlock();
+                break;
+            }
+            if (!(m_flags & FlushRequested)) {
+                m_condition.wait(&m_mutex);
+            }
+        }
+        m_waiting.store(0);
+        int flushCount = 0;
         UMLogger* loggers[UMApplicationMonitorPrivate::maxLoggers];
-        memcpy(loggers, m_loggers, loggerCount * sizeof(UMLogger*));
+        if (m_flags & FlushRequested) {
+            m_flags &= ~FlushRequested;
+            flushCount = m_loggerCount;
+            memcpy(loggers, m_loggers, flushCount * sizeof(UMLogger*));
+        }
         m_mutex.unlock();
-        for (int i = 0; i < loggerCount; ++i) {
-            loggers[i]->log(event);
+        for (int i = 0; i < flushCount; ++i) {
+            loggers[i]->flush();
         }
     }
     DLOG("Leaving logging thread.");
@@ -102,22 +190,43 @@ void LoggingThread::run()
 
 void LoggingThread::push(const UMEvent* event)
 {
-    // Ensure the log queue is not full.
-    m_mutex.lock();
-    DASSERT(m_queueSize <= logQueueSize);
-    while (m_queueSize == logQueueSize) {
-        m_mutex.unlock();
-        QThread::yieldCurrentThread();
-        m_mutex.lock();
+    DASSERT(event->type < UMEvent::TypeCount);
+
+    while (!enqueue(event)) {
+        switch (m_queuePolicy.load()) {
+        case UMApplicationMonitor::Block:
+            QThread::yieldCurrentThread();
+            break;
+        case UMApplicationMonitor::DropOldest: {
+            UMEvent oldestEvent;
+            if (dequeue(&oldestEvent)) {
+                m_droppedEventCount[oldestEvent.type].ref();
+            }
+            break;
+        }
+        case UMApplicationMonitor::DropNewest:
+            m_droppedEventCount[event->type].ref();
+            return;
+        default:
+            DNOT_REACHED();
+            return;
+        }
     }
 
-    // Push event to the log queue.
-    DASSERT(m_queueSize < logQueueSize);
-    memcpy(&m_queue[(m_queueIndex + m_queueSize++) % logQueueSize], event, sizeof(UMEvent));
-    if (m_flags & Waiting) {
+    // Read-modify-write pairing with the one setting the waiting state in
+    // run(), a plain load could miss it on weakly ordered CPUs.
+    if (m_waiting.fetchAndAddOrdered(0)) {
+        m_mutex.lock();
         m_condition.wakeOne();
+        m_mutex.unlock();
     }
-    m_mutex.unlock();
+}
+
+void LoggingThread::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    m_flags |= FlushRequested;
+    m_condition.wakeOne();
 }
 
 void LoggingThread::setLoggers(UMLogger** loggers, int count)
@@ -165,7 +274,10 @@ UMApplicationMonitorPrivate::UMApplicationMonitorPrivate(UMApplicationMonitor* a
     , m_loggingThread(nullptr)
     , m_monitorCount(0)
     , m_loggerCount(0)
-    , m_updateInterval{1000, -1, -1}
+    , m_updateInterval{1000, -1, -1, -1, -1}
+    , m_loggingQueueSize(16)
+    , m_loggingQueuePolicy(UMApplicationMonitor::Block)
+    , m_droppedEventCount{}
     , m_flags(UMApplicationMonitor::AllEvents)
 {
     Q_Q(UMApplicationMonitor);
@@ -181,6 +293,7 @@ UMApplicationMonitorPrivate::UMApplicationMonitorPrivate(UMApplicationMonitor* a
     QObject::connect(application, SIGNAL(lastWindowClosed()), q, SLOT(closeDown()));
     QObject::connect(application, SIGNAL(aboutToQuit()), q, SLOT(closeDown()));
     QObject::connect(&m_processTimer, SIGNAL(timeout()), q, SLOT(processTimeout()));
+    QObject::connect(&m_threadTimer, SIGNAL(timeout()), q, SLOT(threadTimeout()));
 
     m_processTimer.setInterval(m_updateInterval[UMEvent::Process]);
 }
@@ -260,6 +373,17 @@ bool UMApplicationMonitor::logging()
     return !!(d_func()->m_flags & UMApplicationMonitorPrivate::Logging);
 }
 
+void UMApplicationMonitorPrivate::flushLoggers()
+{
+    if (UMApplicationMonitor::self) {
+        UMApplicationMonitorPrivate* d = get(UMApplicationMonitor::self);
+        DASSERT(QThread::currentThread() == d->q_func()->thread());
+        if (d->m_loggingThread) {
+            d->m_loggingThread->flush();
+        }
+    }
+}
+
 void UMApplicationMonitorPrivate::startMonitoring(QQuickWindow* window)
 {
     DASSERT(window);
@@ -282,7 +406,7 @@ void UMApplicationMonitorPrivate::start()
     DASSERT(!(m_flags & Started));
     DASSERT(!m_loggingThread);
 
-    m_loggingThread = new LoggingThread;
+    m_loggingThread = new LoggingThread(m_loggingQueueSize, m_loggingQueuePolicy);
     m_loggingThread->setLoggers(m_loggers, m_loggerCount);
 
     QWindowList windows = QGuiApplication::allWindows();
@@ -307,6 +431,9 @@ void UMApplicationMonitorPrivate::start()
     if (m_updateInterval[UMEvent::Process] >= 0) {
         m_processTimer.start();
     }
+    if (m_updateInterval[UMEvent::Thread] >= 0) {
+        m_threadTimer.start();
+    }
 }
 
 bool UMApplicationMonitorPrivate::removeMonitor(WindowMonitor* monitor)
@@ -380,6 +507,9 @@ void UMApplicationMonitorPrivate::stop()
     if (m_updateInterval[UMEvent::Process] >= 0) {
         m_processTimer.stop();
     }
+    if (m_updateInterval[UMEvent::Thread] >= 0) {
+        m_threadTimer.stop();
+    }
 
     QGuiApplication::instance()->removeEventFilter(q_func());
 
@@ -390,6 +520,10 @@ void UMApplicationMonitorPrivate::stop()
     m_monitorsMutex.unlock();
 
     DASSERT(m_loggingThread);
+    for (int i = 0; i < UMEvent::TypeCount; ++i) {
+        m_droppedEventCount[i] +=
+            m_loggingThread->droppedEventCount(static_cast<UMEvent::Type>(i));
+    }
     m_loggingThread->deref();
     m_loggingThread = nullptr;
 
@@ -552,8 +686,14 @@ void UMApplicationMonitor::clearLoggers(bool free)
 
 quint32 UMApplicationMonitor::registerGenericEvent()
 {
-    static quint32 id = 0;  // 0 is reserved for UMApplicationMonitor events.
-    return ++id;
+    return UMApplicationMonitorPrivate::registerGenericEvent();
+}
+
+quint32 UMApplicationMonitorPrivate::registerGenericEvent()
+{
+    // Loggers register their ids from any thread.
+    static QAtomicInteger<quint32> id(0);  // 0 is reserved for UMApplicationMonitor events.
+    return id.fetchAndAddRelaxed(1) + 1;
 }
 
 bool UMApplicationMonitor::logGenericEvent(quint32 id, const char* string, quint32 size)
@@ -592,25 +732,37 @@ bool UMApplicationMonitor::logEvent(Event event)
     };
 }
 
+QTimer* UMApplicationMonitorPrivate::updateTimer(UMEvent::Type type)
+{
+    switch (type) {
+    case UMEvent::Process:
+        return &m_processTimer;
+    case UMEvent::Thread:
+        return &m_threadTimer;
+    default:
+        // Other types (like UMEvent::Frame) are ignored for now.
+        return nullptr;
+    }
+}
+
 void UMApplicationMonitor::setUpdateInterval(UMEvent::Type type, int interval)
 {
     Q_D(UMApplicationMonitor);
 
-    if (type == UMEvent::Process) {
-        // Other types (like UMEvent::Frame) are ignored for now.
-        if (interval != d->m_updateInterval[UMEvent::Process]) {
+    if (QTimer* timer = d->updateTimer(type)) {
+        if (interval != d->m_updateInterval[type]) {
             if (interval >= 0) {
-                d->m_processTimer.setInterval(interval);
+                timer->setInterval(interval);
                 if ((d->m_flags & UMApplicationMonitorPrivate::Started)
-                    && (d->m_updateInterval[UMEvent::Process] < 0)) {
-                    d->m_processTimer.start();
+                    && (d->m_updateInterval[type] < 0)) {
+                    timer->start();
                 }
             } else if ((d->m_flags & UMApplicationMonitorPrivate::Started)
-                       && (d->m_updateInterval[UMEvent::Process] >= 0)) {
-                d->m_processTimer.stop();
+                       && (d->m_updateInterval[type] >= 0)) {
+                timer->stop();
             }
-            d->m_updateInterval[UMEvent::Process] = interval;
-            Q_EMIT updateIntervalChanged(UMEvent::Process);
+            d->m_updateInterval[type] = interval;
+            Q_EMIT updateIntervalChanged(type);
         }
     }
 }
@@ -620,6 +772,58 @@ int UMApplicationMonitor::updateInterval(UMEvent::Type type)
     return d_func()->m_updateInterval[type];
 }
 
+void UMApplicationMonitor::setLoggingQueueSize(int size)
+{
+    Q_D(UMApplicationMonitor);
+
+    int powerOfTwoSize = UMApplicationMonitorPrivate::minLoggingQueueSize;
+    while (powerOfTwoSize < size
+           && powerOfTwoSize < UMApplicationMonitorPrivate::maxLoggingQueueSize) {
+        powerOfTwoSize <<= 1;
+    }
+    if (powerOfTwoSize != d->m_loggingQueueSize) {
+        d->m_loggingQueueSize = powerOfTwoSize;
+        Q_EMIT loggingQueueSizeChanged();
+    }
+}
+
+int UMApplicationMonitor::loggingQueueSize()
+{
+    return d_func()->m_loggingQueueSize;
+}
+
+void UMApplicationMonitor::setLoggingQueuePolicy(LoggingQueuePolicy policy)
+{
+    Q_D(UMApplicationMonitor);
+
+    if (policy != d->m_loggingQueuePolicy) {
+        d->m_loggingQueuePolicy = policy;
+        if (d->m_flags & UMApplicationMonitorPrivate::Started) {
+            DASSERT(d->m_loggingThread);
+            d->m_loggingThread->setQueuePolicy(policy);
+        }
+        Q_EMIT loggingQueuePolicyChanged();
+    }
+}
+
+UMApplicationMonitor::LoggingQueuePolicy UMApplicationMonitor::loggingQueuePolicy()
+{
+    return d_func()->m_loggingQueuePolicy;
+}
+
+quint32 UMApplicationMonitor::droppedEventCount(UMEvent::Type type)
+{
+    Q_D(UMApplicationMonitor);
+    DASSERT(type < UMEvent::TypeCount);
+
+    quint32 count = d->m_droppedEventCount[type];
+    if (d->m_flags & UMApplicationMonitorPrivate::Started) {
+        DASSERT(d->m_loggingThread);
+        count += d->m_loggingThread->droppedEventCount(type);
+    }
+    return count;
+}
+
 void UMApplicationMonitor::closeDown()
 {
     Q_D(UMApplicationMonitor);
@@ -667,6 +871,28 @@ void UMApplicationMonitorPrivate::processTimeout()
     }
 }
 
+void UMApplicationMonitor::threadTimeout()
+{
+    d_func()->threadTimeout();
+}
+
+void UMApplicationMonitorPrivate::threadTimeout()
+{
+    DASSERT(m_flags & Started);
+    DASSERT(m_loggingThread);
+
+    if ((m_flags & Logging) && (m_flags & UMApplicationMonitor::ThreadEvent)) {
+        if (const quint32 loggingThreadId = m_loggingThread->threadId()) {
+            m_eventUtils.setThreadRole(loggingThreadId, UMThreadEvent::Logging);
+        }
+        UMEvent events[maxThreadEvents];
+        const int count = m_eventUtils.updateThreadEvents(events, maxThreadEvents);
+        for (int i = 0; i < count; ++i) {
+            m_loggingThread->push(&events[i]);
+        }
+    }
+}
+
 bool UMApplicationMonitor::eventFilter(QObject* object, QEvent* event)
 {
     if (event->type() == QEvent::Show) {
@@ -676,6 +902,17 @@ bool UMApplicationMonitor::eventFilter(QObject* object, QEvent* event)
             d->startMonitoring(window);
             d->m_monitorsMutex.unlock();
         }
+    } else if (event->type() == QEvent::UpdateRequest) {
+        // The update request starts the GUI thread part of a QtQuick frame.
+        Q_D(UMApplicationMonitor);
+        d->m_monitorsMutex.lock();
+        for (int i = 0; i < d->m_monitorCount; ++i) {
+            if (d->m_monitors[i]->window() == object) {
+                d->m_monitors[i]->windowUpdateRequested();
+                break;
+            }
+        }
+        d->m_monitorsMutex.unlock();
     }
     return QObject::eventFilter(object, event);
 }
@@ -689,12 +926,14 @@ static const char* const defaultOverlayText =
     "     Frame : %9frameNumber   \n"
     // FIXME(loicm) should be removed once we have a timing histogram with swap included.
     " Delta n-1 : %9deltaTime ms\n"
+    "    Polish : %9polishTime ms\n"
     "  SG sync. : %9syncTime ms\n"
     " SG render : %9renderTime ms\n"
     "       GPU : %9gpuTime ms\n"
     "     Total : %9totalTime ms\r"
     "  VSZ mem. : %9vszMemory kB\n"
     "  RSS mem. : %9rssMemory kB\n"
+    "  PSS mem. : %9pssMemory kB\n"
     "   Threads : %9threadCount   \n"
     " CPU usage : %9cpuUsage %% ";
 
@@ -705,6 +944,10 @@ WindowMonitor::WindowMonitor(
     , m_loggingThread(loggingThread)
     , m_window(window)
     , m_overlay(defaultOverlayText, id)
+    , m_polishTime(0)
+    , m_lastGpuTime(0)
+    , m_pendingFrameIndex(0)
+    , m_pendingFrameCount(0)
     , m_id(id)
     , m_flags(flags)
     , m_frameSize(window->width(), window->height())
@@ -720,6 +963,8 @@ WindowMonitor::WindowMonitor(
                      SLOT(windowSceneGraphInitialized()), Qt::DirectConnection);
     QObject::connect(window, SIGNAL(sceneGraphInvalidated()), this,
                      SLOT(windowSceneGraphInvalidated()), Qt::DirectConnection);
+    QObject::connect(window, SIGNAL(afterAnimating()), this, SLOT(windowAfterAnimating()),
+                     Qt::DirectConnection);
     QObject::connect(window, SIGNAL(beforeSynchronizing()), this,
                      SLOT(windowBeforeSynchronizing()), Qt::DirectConnection);
     QObject::connect(window, SIGNAL(afterSynchronizing()), this,
@@ -777,9 +1022,15 @@ void WindowMonitor::initializeGpuResources()
     //     that behavior programmatically.
     static bool noGpuTimer = qEnvironmentVariableIsSet("UM_NO_GPU_TIMER");
 
+    // Called on the render thread, which isn't necessarily named after
+    // QSGRenderThread (custom render loops for instance).
+    UMApplicationMonitorPrivate::get(m_applicationMonitor)->m_eventUtils.setThreadRole(
+        UMEventUtils::currentThreadId(), UMThreadEvent::Render);
+
     m_overlay.initialize();
     m_gpuTimer.initialize();
     m_frameEvent.frame.number = 0;
+    m_lastGpuTime = 0;
     m_flags |= GpuResourcesInitialized | (!noGpuTimer ? GpuTimerAvailable : 0);
 }
 
@@ -795,6 +1046,7 @@ void WindowMonitor::finalizeGpuResources()
     DASSERT(m_flags & GpuResourcesInitialized);
 
     if (m_flags & GpuTimerAvailable) {
+        collectGpuTimings(true);
         m_gpuTimer.finalize();
     }
     m_overlay.finalize();
@@ -810,10 +1062,35 @@ void WindowMonitor::windowSceneGraphInvalidated()
     }
 }
 
+void WindowMonitor::windowUpdateRequested()
+{
+    // Called on the GUI thread.
+    m_guiTimer.start();
+    m_polishTime = 0;
+}
+
+void WindowMonitor::windowAfterAnimating()
+{
+    // Called on the GUI thread.
+    if (m_guiTimer.isValid()) {
+        m_polishTime = m_guiTimer.nsecsElapsed();
+    }
+}
+
 void WindowMonitor::windowBeforeSynchronizing()
 {
     if (m_flags & GpuResourcesInitialized) {
         m_sceneGraphTimer.start();
+        // The GUI thread is blocked during the synchronization pass, it's safe
+        // to read the GUI timer and polish time here.
+        if (m_guiTimer.isValid()) {
+            m_frameEvent.frame.guiTime = m_guiTimer.nsecsElapsed();
+            m_frameEvent.frame.polishTime = m_polishTime;
+            m_guiTimer.invalidate();
+        } else {
+            m_frameEvent.frame.guiTime = 0;
+            m_frameEvent.frame.polishTime = 0;
+        }
     }
 }
 
@@ -845,6 +1122,12 @@ void WindowMonitor::windowBeforeRendering()
     if (m_flags & GpuResourcesInitialized) {
         m_sceneGraphTimer.start();
         if (m_flags & GpuTimerAvailable) {
+            if (m_gpuTimer.pendingCount() == GPUTimer::maxPendingTimings) {
+                // The GPU is lagging too much behind, drop the oldest timing
+                // instead of stalling the render thread.
+                m_gpuTimer.discard();
+                logPendingFrameEvent(0);
+            }
             m_gpuTimer.start();
         }
     }
@@ -854,8 +1137,21 @@ void WindowMonitor::windowAfterRendering()
 {
     if (m_flags & GpuResourcesInitialized) {
         m_frameEvent.frame.renderTime = m_sceneGraphTimer.nsecsElapsed();
-        m_frameEvent.frame.gpuTime = (m_flags & GpuTimerAvailable) ? m_gpuTimer.stop() : 0;
         m_frameEvent.frame.number++;
+        if (m_flags & GpuTimerAvailable) {
+            // The GPU time of that frame is retrieved a few frames later, the
+            // frame event is kept pending until then. The overlay renders the
+            // latest GPU time available.
+            m_gpuTimer.stop();
+            DASSERT(m_pendingFrameCount < GPUTimer::maxPendingTimings);
+            const int index =
+                (m_pendingFrameIndex + m_pendingFrameCount) % GPUTimer::maxPendingTimings;
+            memcpy(&m_pendingFrameEvents[index], &m_frameEvent, sizeof(UMEvent));
+            m_pendingFrameCount++;
+            m_frameEvent.frame.gpuTime = m_lastGpuTime;
+        } else {
+            m_frameEvent.frame.gpuTime = 0;
+        }
         if (m_flags & UMApplicationMonitorPrivate::Overlay) {
             m_mutex.lock();
             m_overlay.render(m_frameEvent, m_frameSize);
@@ -870,10 +1166,19 @@ void WindowMonitor::windowFrameSwapped()
     if (m_flags & GpuResourcesInitialized) {
         m_frameEvent.frame.deltaTime = m_deltaTimer.isValid() ? m_deltaTimer.nsecsElapsed() : 0;
         m_deltaTimer.start();
-        if ((m_flags & UMApplicationMonitorPrivate::Logging) &&
-            (m_flags & UMApplicationMonitor::FrameEvent)) {
-            m_frameEvent.frame.swapTime = m_sceneGraphTimer.nsecsElapsed();
-            m_frameEvent.timeStamp = UMEventUtils::timeStamp();
+        m_frameEvent.frame.swapTime = m_sceneGraphTimer.nsecsElapsed();
+        m_frameEvent.timeStamp = UMEventUtils::timeStamp();
+        if ((m_flags & GpuTimerAvailable) && m_pendingFrameCount > 0) {
+            // Complete the pending event of the frame just swapped and log the
+            // ones whose GPU time is available.
+            const int index = (m_pendingFrameIndex + m_pendingFrameCount - 1)
+                % GPUTimer::maxPendingTimings;
+            m_pendingFrameEvents[index].frame.deltaTime = m_frameEvent.frame.deltaTime;
+            m_pendingFrameEvents[index].frame.swapTime = m_frameEvent.frame.swapTime;
+            m_pendingFrameEvents[index].timeStamp = m_frameEvent.timeStamp;
+            collectGpuTimings(false);
+        } else if ((m_flags & UMApplicationMonitorPrivate::Logging) &&
+                   (m_flags & UMApplicationMonitor::FrameEvent)) {
             m_loggingThread->push(&m_frameEvent);
         }
     } else {
@@ -884,6 +1189,34 @@ void WindowMonitor::windowFrameSwapped()
     }
 }
 
+void WindowMonitor::collectGpuTimings(bool wait)
+{
+    DASSERT(m_pendingFrameCount == m_gpuTimer.pendingCount());
+
+    if (m_pendingFrameCount > 0) {
+        m_gpuTimer.checkDisjoint();
+    }
+    quint64 gpuTime;
+    while (m_pendingFrameCount > 0 && m_gpuTimer.result(&gpuTime, wait)) {
+        m_lastGpuTime = gpuTime;
+        logPendingFrameEvent(gpuTime);
+    }
+}
+
+void WindowMonitor::logPendingFrameEvent(quint64 gpuTime)
+{
+    DASSERT(m_pendingFrameCount > 0);
+
+    UMEvent* event = &m_pendingFrameEvents[m_pendingFrameIndex];
+    event->frame.gpuTime = gpuTime;
+    if ((m_flags & UMApplicationMonitorPrivate::Logging) &&
+        (m_flags & UMApplicationMonitor::FrameEvent)) {
+        m_loggingThread->push(event);
+    }
+    m_pendingFrameIndex = (m_pendingFrameIndex + 1) % GPUTimer::maxPendingTimings;
+    m_pendingFrameCount--;
+}
+
 void WindowMonitor::windowSceneGraphAboutToStop()
 {
 #if !defined(QT_NO_DEBUG)
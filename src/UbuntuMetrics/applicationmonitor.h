@@ -43,8 +43,10 @@ public:
         FrameEvent   = (1 << 2),
         // Allow generic events logging.
         GenericEvent = (1 << 3),
+        // Allow thread events logging.
+        ThreadEvent  = (1 << 4),
         // Allow all events logging.
-        AllEvents    = (ProcessEvent | WindowEvent | FrameEvent | GenericEvent)
+        AllEvents    = (ProcessEvent | WindowEvent | FrameEvent | GenericEvent | ThreadEvent)
     };
     Q_DECLARE_FLAGS(LoggingFilters, LoggingFilter)
 
@@ -55,6 +57,15 @@ public:
         UserInterfaceReady = 0
     };
 
+    enum LoggingQueuePolicy {
+        // Make the pushing thread wait until the logging thread frees a slot.
+        Block      = 0,
+        // Drop the oldest queued event to make room for the new one.
+        DropOldest = 1,
+        // Drop the new event.
+        DropNewest = 2
+    };
+
     // Get the unique UMApplicationMonitor instance. A QGuiApplication instance
     // must be running.
     static UMApplicationMonitor* instance() { return self ? self : new UMApplicationMonitor; }
@@ -93,22 +104,41 @@ public:
     bool logEvent(Event event);
 
     // Set the time in milliseconds between two updates of events of a given
-    // type. -1 to disable updates. Only UMEvent::Process is accepted so far as
-    // event type, default value is 1000. Note that when the overlay is enabled,
-    // a process update triggers a frame update.
+    // type. -1 to disable updates. Only UMEvent::Process and UMEvent::Thread are
+    // accepted so far as event type, default values are 1000 and -1. Note that
+    // when the overlay is enabled, a process update triggers a frame update. A
+    // thread update logs an event per thread of the process.
     void setUpdateInterval(UMEvent::Type type, int interval);
     int updateInterval(UMEvent::Type type);
 
+    // Set the number of events the logging queue can hold. The size is rounded
+    // up to the next power of two and clamped to [2, 65536], default value is
+    // 16. A change is applied the next time the monitoring is started.
+    void setLoggingQueueSize(int size);
+    int loggingQueueSize();
+
+    // Set the policy applied when an event is pushed to a full logging
+    // queue. Default value is Block.
+    void setLoggingQueuePolicy(LoggingQueuePolicy policy);
+    LoggingQueuePolicy loggingQueuePolicy();
+
+    // Get the number of events of a given type dropped because of a full
+    // logging queue since the creation of the application monitor.
+    quint32 droppedEventCount(UMEvent::Type type);
+
 Q_SIGNALS:
     void overlayChanged();
     void loggingChanged();
     void loggingFilterChanged();
     void loggersChanged();
     void updateIntervalChanged(UMEvent::Type type);
+    void loggingQueueSizeChanged();
+    void loggingQueuePolicyChanged();
 
 private Q_SLOTS:
     void closeDown();
     void processTimeout();
+    void threadTimeout();
 
 private:
     static UMApplicationMonitor* self;
@@ -41,6 +41,9 @@ class UBUNTU_METRICS_PRIVATE_EXPORT UMApplicationMonitorPrivate
 public:
     static const int maxMonitors = 16;
     static const int maxLoggers = 8;
+    static const int maxThreadEvents = 64;
+    static const int minLoggingQueueSize = 2;
+    static const int maxLoggingQueueSize = 65536;
 
     static inline UMApplicationMonitorPrivate* get(UMApplicationMonitor* applicationMonitor) {
         return applicationMonitor->d_func();
@@ -61,6 +64,12 @@ public:
     UMApplicationMonitorPrivate(UMApplicationMonitor* applicationMonitor);
     ~UMApplicationMonitorPrivate();
 
+    // Wakes the logging thread up to flush the loggers, if logging.
+    static void flushLoggers();
+
+    // Returns a unique generic event id, 0 is reserved for the monitor events.
+    static quint32 registerGenericEvent();
+
     void startMonitoring(QQuickWindow* window);
     void start();
     bool removeMonitor(WindowMonitor* monitor);
@@ -69,6 +78,8 @@ public:
     bool hasMonitor(WindowMonitor* monitor);
     void setMonitoringFlags(quint32 flags);
     void processTimeout();
+    void threadTimeout();
+    QTimer* updateTimer(UMEvent::Type type);
 
     UMApplicationMonitor* const q_ptr;
     Q_DECLARE_PUBLIC(UMApplicationMonitor)
@@ -81,42 +92,77 @@ public:
 #endif
     UMEventUtils m_eventUtils;
     QTimer m_processTimer;
+    QTimer m_threadTimer;
     QMutex m_monitorsMutex;
     int m_monitorCount;
     int m_loggerCount;
     int m_updateInterval[UMEvent::TypeCount];
+    int m_loggingQueueSize;
+    UMApplicationMonitor::LoggingQueuePolicy m_loggingQueuePolicy;
+    quint32 m_droppedEventCount[UMEvent::TypeCount];
     quint32 m_flags;
     alignas(64) UMEvent m_processEvent;
 };
 
+// Logging thread consuming the events pushed by the window monitors (render
+// threads) and the application monitor (GUI thread). The log queue is a
+// bounded lock-free ring, based on Dmitry Vyukov's MPMC queue, in which each
+// slot stores a sequence number telling whether it's ready to be written or
+// read. The mutex is only used to set the loggers and to put the logging
+// thread to sleep when the queue is empty, push() never takes it unless the
+// logging thread is waiting.
 class UBUNTU_METRICS_PRIVATE_EXPORT LoggingThread : public QThread
 {
 public:
-    LoggingThread();
+    LoggingThread(int queueSize, UMApplicationMonitor::LoggingQueuePolicy policy);
 
     void run() override;
     void push(const UMEvent* event);
     void setLoggers(UMLogger** loggers, int count);
+    void flush();
+    void setQueuePolicy(UMApplicationMonitor::LoggingQueuePolicy policy) {
+        m_queuePolicy.store(policy);
+    }
+    quint32 droppedEventCount(UMEvent::Type type) const {
+        return m_droppedEventCount[type].load();
+    }
+    quint32 threadId() const { return m_threadId.load(); }
     LoggingThread* ref();
     void deref();
 
 private:
     enum {
-        Waiting       = (1 << 0),
-        JoinRequested = (1 << 1)
+        JoinRequested  = (1 << 0),
+        FlushRequested = (1 << 1)
+    };
+
+    struct alignas(64) QueueSlot {
+        QAtomicInteger<quint32> sequence;
+        UMEvent event;
     };
 
     ~LoggingThread();
 
-    UMEvent* m_queue;
+    bool enqueue(const UMEvent* event);
+    bool dequeue(UMEvent* event);
+    bool isQueueEmpty() const;
+
+    QueueSlot* m_queue;
     UMLogger* m_loggers[UMApplicationMonitorPrivate::maxLoggers];
     int m_loggerCount;
     QMutex m_mutex;
     QWaitCondition m_condition;
     QAtomicInteger<quint32> m_refCount;
-    qint8 m_queueIndex;
-    qint8 m_queueSize;
+    QAtomicInteger<quint32> m_droppedEventCount[UMEvent::TypeCount];
+    QAtomicInteger<quint32> m_waiting;
+    QAtomicInteger<int> m_queuePolicy;
+    QAtomicInteger<quint32> m_threadId;
+    const quint32 m_queueMask;
     quint8 m_flags;
+    // Producer and consumer positions are kept on their own cache line to
+    // prevent false sharing.
+    alignas(64) QAtomicInteger<quint32> m_enqueuePosition;
+    alignas(64) QAtomicInteger<quint32> m_dequeuePosition;
 };
 
 class UBUNTU_METRICS_PRIVATE_EXPORT WindowMonitorDeleter : public QRunnable
@@ -170,10 +216,12 @@ public:
 
     QQuickWindow* window() const { return m_window; }
     void setProcessEvent(const UMEvent& event);
+    void windowUpdateRequested();
 
 private Q_SLOTS:
     void windowSceneGraphInitialized();
     void windowSceneGraphInvalidated();
+    void windowAfterAnimating();
     void windowBeforeSynchronizing();
     void windowAfterSynchronizing();
     void windowBeforeRendering();
@@ -196,6 +244,8 @@ private:
     }
     void initializeGpuResources();
     void finalizeGpuResources();
+    void collectGpuTimings(bool wait);
+    void logPendingFrameEvent(quint64 gpuTime);
 
     UMApplicationMonitor* m_applicationMonitor;
     LoggingThread* m_loggingThread;
@@ -205,10 +255,20 @@ private:
     QMutex m_mutex;
     QElapsedTimer m_sceneGraphTimer;
     QElapsedTimer m_deltaTimer;
+    // Started on the GUI thread and read on the render thread while the GUI
+    // thread is blocked on the synchronization pass.
+    QElapsedTimer m_guiTimer;
+    quint64 m_polishTime;
+    quint64 m_lastGpuTime;
+    int m_pendingFrameIndex;
+    int m_pendingFrameCount;
     quint32 m_id;
     quint32 m_flags;
     QSize m_frameSize;
     UMEvent m_frameEvent;
+    // Frame events waiting for their GPU time, in the same order than the
+    // pending timings of the GPU timer.
+    UMEvent m_pendingFrameEvents[GPUTimer::maxPendingTimings];
 
     friend class WindowMonitorDeleter;
     friend class WindowMonitorFlagSetter;
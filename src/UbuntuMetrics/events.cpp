@@ -20,13 +20,15 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <dirent.h>
+#include <sys/syscall.h>
 #include <cstdio>
 
 #include <QtCore/QElapsedTimer>
 
 #include "ubuntumetricsglobal_p.h"
 
-const int bufferSize = 128;
+const int bufferSize = 1024;
 const int bufferAlignment = 64;
 
 UMEventUtils::UMEventUtils()
@@ -42,9 +44,19 @@ EventUtilsPrivate::EventUtilsPrivate()
     m_buffer = static_cast<char*>(alignedAlloc(bufferAlignment, bufferSize));
 #endif
     m_cpuTimer.start();
-    m_cpuTicks = times(&m_cpuTimes);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &m_cpuTime);
+    getrusage(RUSAGE_SELF, &m_resourceUsage);
     m_cpuOnlineCores = sysconf(_SC_NPROCESSORS_ONLN);
     m_pageSize = sysconf(_SC_PAGESIZE);
+    m_processId = getpid();
+    m_clockTicks = sysconf(_SC_CLK_TCK);
+
+    m_procStatFd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    if (m_procStatFd == -1) {
+        DWARN("EventUtils: can't open '/proc/self/stat'");
+    }
+    // Not available before Linux 4.14, PSS and swap metrics are left to 0.
+    m_smapsRollupFd = open("/proc/self/smaps_rollup", O_RDONLY | O_CLOEXEC);
 }
 
 UMEventUtils::~UMEventUtils()
@@ -54,6 +66,15 @@ UMEventUtils::~UMEventUtils()
 
 EventUtilsPrivate::~EventUtilsPrivate()
 {
+    if (m_procStatFd != -1) {
+        close(m_procStatFd);
+    }
+    if (m_smapsRollupFd != -1) {
+        close(m_smapsRollupFd);
+    }
+    for (auto it = m_threads.constBegin(); it != m_threads.constEnd(); ++it) {
+        close(it->fd);
+    }
     free(m_buffer);
 }
 
@@ -65,40 +86,55 @@ void UMEventUtils::updateProcessEvent(UMEvent* event)
     event->type = UMEvent::Process;
     event->timeStamp = UMEventUtils::timeStamp();
     d->updateCpuUsage(event);
+    d->updateResourceUsage(event);
     d->updateProcStatMetrics(event);
+    d->updateSmapsRollupMetrics(event);
 }
 
 void EventUtilsPrivate::updateCpuUsage(UMEvent* event)
 {
-    // times() is a Linux syscall giving CPU times used by the process. The
-    // granularity of the unit returned by the (some?) kernel (clock ticks)
-    // prevents us from getting precise timings at a high frequency, so we have
-    // to throttle to 200 ms (5 Hz).
-    const qint64 throttlingFrequency = 200;
-    if (m_cpuTimer.elapsed() > throttlingFrequency) {
-        struct tms newCpuTimes;
-        const clock_t newTicks = times(&newCpuTimes);
-        const clock_t ticks = newTicks - m_cpuTicks;
-        const clock_t userTime = newCpuTimes.tms_utime - m_cpuTimes.tms_utime;
-        const clock_t systemTime = newCpuTimes.tms_stime - m_cpuTimes.tms_stime;
-        event->process.cpuUsage = ((userTime + systemTime) * 100) / (ticks * m_cpuOnlineCores);
+    // The CPU time of the process clock has a nanosecond resolution, as
+    // opposed to the clock ticks returned by times(), so there's no need to
+    // throttle the updates. We just skip updates too close to each other to
+    // be meaningful.
+    const qint64 minInterval = 1000000;
+    const qint64 elapsedTime = m_cpuTimer.nsecsElapsed();
+    if (elapsedTime > minInterval) {
+        struct timespec newCpuTime;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &newCpuTime);
+        const qint64 cpuTime = (newCpuTime.tv_sec - m_cpuTime.tv_sec) * Q_INT64_C(1000000000)
+            + (newCpuTime.tv_nsec - m_cpuTime.tv_nsec);
+        event->process.cpuUsage = (cpuTime * 100) / (elapsedTime * m_cpuOnlineCores);
         m_cpuTimer.start();
-        memcpy(&m_cpuTimes, &newCpuTimes, sizeof(struct tms));
-        m_cpuTicks = newTicks;
+        m_cpuTime = newCpuTime;
     }
 }
 
+void EventUtilsPrivate::updateResourceUsage(UMEvent* event)
+{
+    struct rusage newResourceUsage;
+    if (getrusage(RUSAGE_SELF, &newResourceUsage) == -1) {
+        DWARN("EventUtils: can't get resource usage");
+        return;
+    }
+
+    event->process.voluntaryContextSwitches =
+        newResourceUsage.ru_nvcsw - m_resourceUsage.ru_nvcsw;
+    event->process.involuntaryContextSwitches =
+        newResourceUsage.ru_nivcsw - m_resourceUsage.ru_nivcsw;
+    event->process.minorPageFaults = newResourceUsage.ru_minflt - m_resourceUsage.ru_minflt;
+    event->process.majorPageFaults = newResourceUsage.ru_majflt - m_resourceUsage.ru_majflt;
+    memcpy(&m_resourceUsage, &newResourceUsage, sizeof(struct rusage));
+}
+
 void EventUtilsPrivate::updateProcStatMetrics(UMEvent* event)
 {
-    int fd = open("/proc/self/stat", O_RDONLY);
-    if (fd == -1) {
-        DWARN("EventUtils: can't open '/proc/self/stat'");
+    if (m_procStatFd == -1) {
         return;
     }
     int readSize;
-    if ((readSize = read(fd, m_buffer, bufferSize)) == 0) {
+    if ((readSize = pread(m_procStatFd, m_buffer, bufferSize, 0)) <= 0) {
         DWARN("EventUtils: can't read '/proc/self/stat'");
-        close(fd);
         return;
     }
 
@@ -121,7 +157,6 @@ void EventUtilsPrivate::updateProcStatMetrics(UMEvent* event)
         } else {
             DASSERT(readSize == bufferSize); // Missing entries in /proc/self/stat.
             DNOT_REACHED();  // Consider increasing bufferSize.
-            close(fd);
             return;
         }
     }
@@ -141,8 +176,186 @@ void EventUtilsPrivate::updateProcStatMetrics(UMEvent* event)
     event->process.vszMemory = vsize >> 10;
     event->process.rssMemory = (rss * m_pageSize) >> 10;
     event->process.threadCount = threadCount;
+}
+
+void EventUtilsPrivate::updateSmapsRollupMetrics(UMEvent* event)
+{
+    if (m_smapsRollupFd == -1) {
+        return;
+    }
+    int readSize;
+    if ((readSize = pread(m_smapsRollupFd, m_buffer, bufferSize - 1, 0)) <= 0) {
+        DWARN("EventUtils: can't read '/proc/self/smaps_rollup'");
+        return;
+    }
+    m_buffer[readSize] = '\0';
+
+    // Values are listed in kB, one per line, after the address range line.
+    unsigned int value;
+    if (const char* pss = strstr(m_buffer, "\nPss:")) {
+        if (std::sscanf(pss + sizeof("\nPss:") - 1, "%u", &value) == 1) {
+            event->process.pssMemory = value;
+        }
+    }
+    if (const char* swap = strstr(m_buffer, "\nSwap:")) {
+        if (std::sscanf(swap + sizeof("\nSwap:") - 1, "%u", &value) == 1) {
+            event->process.swapMemory = value;
+        }
+    }
+}
+
+int UMEventUtils::updateThreadEvents(UMEvent* events, int maxCount)
+{
+    DASSERT(events);
+    DASSERT(maxCount > 0);
+
+    return d_func()->updateThreadEvents(events, maxCount);
+}
+
+int EventUtilsPrivate::updateThreadEvents(UMEvent* events, int maxCount)
+{
+    DIR* directory = opendir("/proc/self/task");
+    if (!directory) {
+        DWARN("EventUtils: can't open '/proc/self/task'");
+        return 0;
+    }
+
+    const quint64 timeStamp = UMEventUtils::timeStamp();
+    const qint64 elapsedTime = m_threadTimer.isValid() ? m_threadTimer.nsecsElapsed() : 0;
+    m_threadTimer.start();
+    for (auto it = m_threads.begin(); it != m_threads.end(); ++it) {
+        it->alive = false;
+    }
 
-    close(fd);
+    int count = 0;
+    while (struct dirent* entry = readdir(directory)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        const quint32 id = strtoul(entry->d_name, nullptr, 10);
+        auto thread = m_threads.find(id);
+        if (thread == m_threads.end()) {
+            char path[64];
+            snprintf(path, sizeof(path), "/proc/self/task/%u/stat", id);
+            const int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd == -1) {
+                continue;  // Exited in the meantime.
+            }
+            thread = m_threads.insert(id, { fd, 0, 0, false, false });
+        }
+        thread->alive = true;
+
+        int readSize;
+        if ((readSize = pread(thread->fd, m_buffer, bufferSize - 1, 0)) <= 0) {
+            continue;
+        }
+        m_buffer[readSize] = '\0';
+
+        // The name is enclosed in parentheses and can contain spaces and
+        // parentheses, the entries are parsed from the last closing one. utime
+        // and stime are the 14th and 15th entries (as listed by 'man proc').
+        const char* nameStart = strchr(m_buffer, '(');
+        const char* nameEnd = strrchr(m_buffer, ')');
+        unsigned long userTicks, systemTicks;
+        if (!nameStart || !nameEnd || nameEnd < nameStart
+            || std::sscanf(nameEnd + 1, " %*c %*d %*d %*d %*d %*d %*u %*lu %*lu %*lu %*lu %lu %lu",
+                           &userTicks, &systemTicks) != 2) {
+            DWARN("EventUtils: can't parse thread stat");
+            continue;
+        }
+
+        // The first sample of a thread only seeds the counters, as does a
+        // counter going backwards (thread id reused by a new thread between two
+        // updates), so that deltas never cover the lifetime of a thread nor
+        // underflow.
+        if (!thread->sampled || userTicks < thread->userTicks
+            || systemTicks < thread->systemTicks) {
+            thread->userTicks = userTicks;
+            thread->systemTicks = systemTicks;
+            thread->sampled = true;
+        }
+
+        if (count < maxCount) {
+            UMEvent* event = &events[count++];
+            memset(event, 0, sizeof(UMEvent));
+            event->type = UMEvent::Thread;
+            event->timeStamp = timeStamp;
+            event->thread.id = id;
+            event->thread.userTime =
+                ((userTicks - thread->userTicks) * Q_UINT64_C(1000000)) / m_clockTicks;
+            event->thread.systemTime =
+                ((systemTicks - thread->systemTicks) * Q_UINT64_C(1000000)) / m_clockTicks;
+            if (elapsedTime > 0) {
+                event->thread.cpuUsage = qMin(
+                    ((event->thread.userTime + event->thread.systemTime) * 100000)
+                    / elapsedTime, Q_UINT64_C(0xffff));
+            }
+            const int nameSize =
+                qMin(static_cast<int>(nameEnd - nameStart - 1),
+                     static_cast<int>(UMThreadEvent::maxNameSize - 1));
+            memcpy(event->thread.name, nameStart + 1, nameSize);
+            event->thread.role = threadRole(id, event->thread.name);
+        }
+        thread->userTicks = userTicks;
+        thread->systemTicks = systemTicks;
+    }
+    closedir(directory);
+
+    // Forget the threads that exited.
+    for (auto it = m_threads.begin(); it != m_threads.end(); ) {
+        if (!it->alive) {
+            close(it->fd);
+            m_threadRolesMutex.lock();
+            m_threadRoles.remove(it.key());
+            m_threadRolesMutex.unlock();
+            it = m_threads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return count;
+}
+
+UMThreadEvent::Role EventUtilsPrivate::threadRole(quint32 id, const char* name)
+{
+    if (id == m_processId) {
+        return UMThreadEvent::Gui;
+    }
+
+    m_threadRolesMutex.lock();
+    auto role = m_threadRoles.constFind(id);
+    if (role != m_threadRoles.constEnd()) {
+        const UMThreadEvent::Role value = *role;
+        m_threadRolesMutex.unlock();
+        return value;
+    }
+    m_threadRolesMutex.unlock();
+
+    // Threads are named after their QThread object name or class name.
+    if (!strncmp(name, "QSGRenderThread", sizeof("QSGRenderThread") - 1)) {
+        return UMThreadEvent::Render;
+    } else if (!strncmp(name, "QQml", sizeof("QQml") - 1)
+               || !strncmp(name, "QQuickPixmap", sizeof("QQuickPixmap") - 1)) {
+        return UMThreadEvent::QmlWorker;
+    } else {
+        return UMThreadEvent::Unknown;
+    }
+}
+
+void UMEventUtils::setThreadRole(quint32 id, UMThreadEvent::Role role)
+{
+    DASSERT(role < UMThreadEvent::RoleCount);
+    Q_D(EventUtils);
+
+    QMutexLocker locker(&d->m_threadRolesMutex);
+    d->m_threadRoles.insert(id, role);
+}
+
+// static.
+quint32 UMEventUtils::currentThreadId()
+{
+    return syscall(SYS_gettid);
 }
 
 // static.
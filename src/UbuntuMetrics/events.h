@@ -39,9 +39,27 @@ struct UBUNTU_METRICS_EXPORT UMProcessEvent
     // Number of threads at buffer swap.
     quint16 threadCount;
 
+    // Proportional set size (PSS) of the process in kilobytes. 0 if not
+    // available (requires /proc/self/smaps_rollup, Linux >= 4.14).
+    quint32 pssMemory;
+
+    // Amount of memory of the process swapped out in kilobytes. 0 if not
+    // available (requires /proc/self/smaps_rollup, Linux >= 4.14).
+    quint32 swapMemory;
+
+    // Number of voluntary and involuntary context switches since the previous
+    // process event.
+    quint32 voluntaryContextSwitches;
+    quint32 involuntaryContextSwitches;
+
+    // Number of minor (not requiring I/O) and major (requiring I/O) page faults
+    // since the previous process event.
+    quint32 minorPageFaults;
+    quint32 majorPageFaults;
+
     // The whole struct must take 112 bytes to allow future additions and best
     // memory alignment, don't forget to update when adding new metrics.
-    quint8 __reserved[/*12 bytes taken,*/ 100 /*bytes free*/];
+    quint8 __reserved[/*36 bytes taken,*/ 76 /*bytes free*/];
 };
 Q_STATIC_ASSERT(sizeof(UMProcessEvent) == 112);
 
@@ -87,15 +105,32 @@ struct UBUNTU_METRICS_EXPORT UMFrameEvent
     quint64 renderTime;
 
     // Time in nanoseconds taken by the GPU to execute the graphics commands
-    // pushed during the QtQuick scene graph render pass.
+    // pushed during the QtQuick scene graph render pass. 0 if not available. GPU
+    // timings being retrieved asynchronously, frame events are logged a few
+    // frames after the swap (their time stamp is still the swap time).
     quint64 gpuTime;
 
     // Time in nanoseconds taken by the graphics subsystem's buffer swap call.
     quint64 swapTime;
 
+    // Time in nanoseconds spent on the GUI thread from the window update
+    // request to the end of the QtQuick polish pass (afterAnimating()
+    // signal). It includes the delivery of frame-synchronous input events, the
+    // items' updatePolish() calls and, with render loops advancing animations
+    // before polishing, the animation tick. 0 if the frame wasn't triggered
+    // by an update request (expose events for instance).
+    quint64 polishTime;
+
+    // Time in nanoseconds spent on the GUI thread from the window update
+    // request to the start of the QtQuick scene graph synchronization pass,
+    // polishTime included. Together with syncTime, renderTime and swapTime, it
+    // covers the whole frame. 0 if the frame wasn't triggered by an update
+    // request.
+    quint64 guiTime;
+
     // The whole struct must take 112 bytes to allow future additions and best
     // memory alignment, don't forget to update when adding new metrics.
-    quint8 __reserved[/*48 bytes taken,*/ 64 /*bytes free*/];
+    quint8 __reserved[/*64 bytes taken,*/ 48 /*bytes free*/];
 };
 Q_STATIC_ASSERT(sizeof(UMFrameEvent) == 112);
 
@@ -118,9 +153,41 @@ struct UBUNTU_METRICS_EXPORT UMGenericEvent
 };
 Q_STATIC_ASSERT(sizeof(UMGenericEvent) == 112);
 
+struct UBUNTU_METRICS_EXPORT UMThreadEvent
+{
+    enum Role {
+        Unknown = 0, Gui = 1, Render = 2, Logging = 3, QmlWorker = 4, RoleCount = 5
+    };
+
+    static const quint32 maxNameSize = 16;
+
+    // CPU time in microseconds spent by the thread in user mode and in kernel
+    // mode since the previous thread event. 0 for the first event of a thread.
+    quint64 userTime;
+    quint64 systemTime;
+
+    // Thread id (as returned by gettid()).
+    quint32 id;
+
+    // CPU usage of the thread as a percentage of a single core since the
+    // previous thread event.
+    quint16 cpuUsage;
+
+    // Role of the thread in the QtQuick application.
+    Role role : 8;
+
+    // Null-terminated name of the thread (truncated to 15 chars by Linux).
+    char name[maxNameSize];
+
+    // The whole struct must take 112 bytes to allow future additions and best
+    // memory alignment, don't forget to update when adding new metrics.
+    quint8 __reserved[/*39 bytes taken,*/ 73 /*bytes free*/];
+};
+Q_STATIC_ASSERT(sizeof(UMThreadEvent) == 112);
+
 struct UBUNTU_METRICS_EXPORT UMEvent
 {
-    enum Type { Process = 0, Window = 1, Frame = 2, Generic = 3, TypeCount = 4 };
+    enum Type { Process = 0, Window = 1, Frame = 2, Generic = 3, Thread = 4, TypeCount = 5 };
 
     // Event type.
     Type type;
@@ -133,6 +200,7 @@ struct UBUNTU_METRICS_EXPORT UMEvent
         UMWindowEvent window;
         UMFrameEvent frame;
         UMGenericEvent generic;
+        UMThreadEvent thread;
     };
 };
 Q_STATIC_ASSERT(sizeof(UMEvent) == 128);
@@ -149,6 +217,18 @@ public:
     // Fill the given event with updated process metrics.
     void updateProcessEvent(UMEvent* event);
 
+    // Fill up to maxCount events with updated metrics for each thread of the
+    // process and return the number of events filled. Thread roles are guessed
+    // from the thread names, the main thread is the GUI thread.
+    int updateThreadEvents(UMEvent* events, int maxCount);
+
+    // Set the role of a thread, for the threads whose names don't tell. Can be
+    // called from any thread.
+    void setThreadRole(quint32 id, UMThreadEvent::Role role);
+
+    // Get the id of the calling thread.
+    static quint32 currentThreadId();
+
     // Get a time stamp in nanoseconds. The timer is started at the first call,
     // returning 0.
     static quint64 timeStamp();
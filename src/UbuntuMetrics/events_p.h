@@ -20,9 +20,12 @@
 
 #include <UbuntuMetrics/events.h>
 
-#include <sys/times.h>
+#include <time.h>
+#include <sys/resource.h>
 
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
 
 #include <UbuntuMetrics/private/ubuntumetricsglobal_p.h>
 
@@ -33,12 +36,34 @@ public:
     ~EventUtilsPrivate();
 
     void updateCpuUsage(UMEvent* event);
+    void updateResourceUsage(UMEvent* event);
     void updateProcStatMetrics(UMEvent* event);
+    void updateSmapsRollupMetrics(UMEvent* event);
+    int updateThreadEvents(UMEvent* events, int maxCount);
+    UMThreadEvent::Role threadRole(quint32 id, const char* name);
+
+    struct ThreadStat {
+        int fd;
+        quint64 userTicks;
+        quint64 systemTicks;
+        bool alive;
+        bool sampled;
+    };
 
     char* m_buffer;
     QElapsedTimer m_cpuTimer;
-    struct tms m_cpuTimes;
-    clock_t m_cpuTicks;
+    struct timespec m_cpuTime;
+    struct rusage m_resourceUsage;
+    // The proc files are kept open and read with pread() at each update.
+    int m_procStatFd;
+    int m_smapsRollupFd;
+    // Per-thread stat files, kept open while the threads live.
+    QHash<quint32, ThreadStat> m_threads;
+    QHash<quint32, UMThreadEvent::Role> m_threadRoles;
+    QMutex m_threadRolesMutex;
+    QElapsedTimer m_threadTimer;
+    quint32 m_processId;
+    quint32 m_clockTicks;
     quint16 m_cpuOnlineCores;
     quint16 m_pageSize;
 };
@@ -24,6 +24,38 @@
 #if !defined(QT_OPENGL_ES) && !defined(GL_TIME_ELAPSED)
 #define GL_TIME_ELAPSED 0x88BF  // For GL_EXT_timer_query.
 #endif
+#if !defined(GL_QUERY_RESULT)
+#define GL_QUERY_RESULT 0x8866
+#endif
+#if !defined(GL_QUERY_RESULT_AVAILABLE)
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#if !defined(GL_TIMESTAMP)
+#define GL_TIMESTAMP 0x8E28
+#endif
+#if defined(QT_OPENGL_ES) && !defined(GL_GPU_DISJOINT_EXT)
+#define GL_GPU_DISJOINT_EXT 0x8FBB  // For GL_EXT_disjoint_timer_query.
+#endif
+#if !defined(GL_QUERY_COUNTER_BITS)
+#define GL_QUERY_COUNTER_BITS 0x8864
+#endif
+
+typedef void (QOPENGLF_APIENTRYP GetQueryivFunc)(GLenum target, GLenum pname, GLint* params);
+
+// Some drivers expose timer queries with counters of 0 bits, the results are
+// then garbage and the timer has to fall back to another method.
+static bool hasCounterBits(GetQueryivFunc getQueryiv, GLenum target)
+{
+    GLint bits = 0;
+    if (getQueryiv) {
+        getQueryiv(target, GL_QUERY_COUNTER_BITS, &bits);
+    }
+    if (bits <= 0) {
+        DLOG("GPUTimer ignores timer queries with a 0 bits counter");
+        return false;
+    }
+    return true;
+}
 
 void GPUTimer::initialize()
 {
@@ -41,8 +73,28 @@ void GPUTimer::initialize()
     QList<QByteArray> glExtensions = QByteArray(
         reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS))).split(' ');
 
+    // DisjointTimerQuery.
+    if (glExtensions.contains("GL_EXT_disjoint_timer_query")
+        && hasCounterBits(reinterpret_cast<GetQueryivFunc>(
+                              eglGetProcAddress("glGetQueryivEXT")), GL_TIMESTAMP)) {
+        m_disjointTimerQuery.genQueriesEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
+                eglGetProcAddress("glGenQueriesEXT"));
+        m_disjointTimerQuery.deleteQueriesEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, const GLuint*)>(
+                eglGetProcAddress("glDeleteQueriesEXT"));
+        m_disjointTimerQuery.queryCounterEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum)>(
+                eglGetProcAddress("glQueryCounterEXT"));
+        m_disjointTimerQuery.getQueryObjectui64vEXT =
+            reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, quint64*)>(
+                eglGetProcAddress("glGetQueryObjectui64vEXT"));
+        m_disjointTimerQuery.genQueriesEXT(2 * maxPendingTimings, m_timer);
+        m_type = DisjointTimerQuery;
+        DLOG("GPUTimer is based on GL_EXT_disjoint_timer_query");
+
     // KHRFence.
-    if (eglExtensions.contains("EGL_KHR_fence_sync")
+    } else if (eglExtensions.contains("EGL_KHR_fence_sync")
         && (glExtensions.contains("GL_OES_EGL_sync")
             || glExtensions.contains("GL_OES_egl_sync") /*PowerVR fix*/)) {
         m_fenceSyncKHR.createSyncKHR = reinterpret_cast<
@@ -54,6 +106,7 @@ void GPUTimer::initialize()
         m_fenceSyncKHR.clientWaitSyncKHR = reinterpret_cast<
             EGLint (QOPENGLF_APIENTRYP)(EGLDisplay, EGLSyncKHR, EGLint, EGLTimeKHR)>(
                 eglGetProcAddress("eglClientWaitSyncKHR"));
+        m_beforeSync = EGL_NO_SYNC_KHR;
         m_type = KHRFence;
         DLOG("GPUTimer is based on GL_OES_EGL_sync");
 
@@ -80,10 +133,13 @@ void GPUTimer::initialize()
     // TODO(loicm) Add an hasQuerycounter() method to QOpenGLTimerQuery.
     QOpenGLContext* context = QOpenGLContext::currentContext();
     QSurfaceFormat format = context->format();
+    GetQueryivFunc getQueryiv =
+        reinterpret_cast<GetQueryivFunc>(context->getProcAddress("glGetQueryiv"));
 
     // ARBTimerQuery.
     if (qMakePair(format.majorVersion(), format.minorVersion()) >= qMakePair(3, 2)
-        && context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"))) {
+        && context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"))
+        && hasCounterBits(getQueryiv, GL_TIMESTAMP)) {
         m_timerQuery.genQueries = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
             context->getProcAddress("glGenQueries"));
         m_timerQuery.deleteQueries =
@@ -94,12 +150,13 @@ void GPUTimer::initialize()
                 context->getProcAddress("glGetQueryObjectui64v"));
         m_timerQuery.queryCounter = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum)>(
             context->getProcAddress("glQueryCounter"));
-        m_timerQuery.genQueries(2, m_timer);
+        m_timerQuery.genQueries(2 * maxPendingTimings, m_timer);
         m_type = ARBTimerQuery;
         DLOG("GPUTimer is based on GL_ARB_timer_query");
 
     // EXTTimerQuery.
-    } else if (context->hasExtension(QByteArrayLiteral("GL_EXT_timer_query"))) {
+    } else if (context->hasExtension(QByteArrayLiteral("GL_EXT_timer_query"))
+               && hasCounterBits(getQueryiv, GL_TIME_ELAPSED)) {
         m_timerQuery.genQueries = reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLsizei, GLuint*)>(
             context->getProcAddress("glGenQueries"));
         m_timerQuery.deleteQueries =
@@ -112,7 +169,7 @@ void GPUTimer::initialize()
         m_timerQuery.getQueryObjectui64vExt =
             reinterpret_cast<void (QOPENGLF_APIENTRYP)(GLuint, GLenum, GLuint64EXT*)>(
                 context->getProcAddress("glGetQueryObjectui64vEXT"));
-        m_timerQuery.genQueries(1, m_timer);
+        m_timerQuery.genQueries(maxPendingTimings, m_timer);
         m_type = EXTTimerQuery;
         DLOG("GPUTimer is based on GL_EXT_timer_query");
     }
@@ -122,6 +179,18 @@ void GPUTimer::initialize()
         m_type = Finish;
         DLOG("GPUTimer is based on glFinish");
     }
+
+    m_pendingIndex = 0;
+    m_pendingCount = 0;
+}
+
+bool GPUTimer::isQueryBased() const
+{
+#if defined(QT_OPENGL_ES)
+    return m_type == DisjointTimerQuery;
+#else
+    return m_type == ARBTimerQuery || m_type == EXTTimerQuery;
+#endif
 }
 
 void GPUTimer::finalize()
@@ -133,9 +202,18 @@ void GPUTimer::finalize()
     m_context = nullptr;
 #endif
 
+    m_pendingIndex = 0;
+    m_pendingCount = 0;
+    m_invalidCount = 0;
+
 #if defined(QT_OPENGL_ES)
+    // DisjointTimerQuery.
+    if (m_type == DisjointTimerQuery) {
+        m_disjointTimerQuery.deleteQueriesEXT(2 * maxPendingTimings, m_timer);
+        m_type = Unset;
+
     // KHRFence.
-    if (m_type == KHRFence) {
+    } else if (m_type == KHRFence) {
         if (m_beforeSync != EGL_NO_SYNC_KHR) {
             m_fenceSyncKHR.destroySyncKHR(eglGetCurrentDisplay(), m_beforeSync);
         }
@@ -149,12 +227,12 @@ void GPUTimer::finalize()
 #else
     // ARBTimerQuery.
     if (m_type == ARBTimerQuery) {
-        m_timerQuery.deleteQueries(2, m_timer);
+        m_timerQuery.deleteQueries(2 * maxPendingTimings, m_timer);
         m_type = Unset;
 
     // EXTTimerQuery.
     } else if (m_type == EXTTimerQuery) {
-        m_timerQuery.deleteQueries(1, m_timer);
+        m_timerQuery.deleteQueries(maxPendingTimings, m_timer);
         m_type = Unset;
     }
 #endif
@@ -165,14 +243,21 @@ void GPUTimer::start()
     DASSERT(m_context == QOpenGLContext::currentContext());
     DASSERT(m_type != Unset);
     DASSERT(!m_started);
+    DASSERT(m_pendingCount < maxPendingTimings);
 
 #if !defined QT_NO_DEBUG
     m_started = true;
 #endif
 
+    const int index = (m_pendingIndex + m_pendingCount) % maxPendingTimings;
+
 #if defined(QT_OPENGL_ES)
+    // DisjointTimerQuery.
+    if (m_type == DisjointTimerQuery) {
+        m_disjointTimerQuery.queryCounterEXT(m_timer[2 * index], GL_TIMESTAMP);
+
     // KHRFence.
-    if (m_type == KHRFence) {
+    } else if (m_type == KHRFence) {
         m_beforeSync = m_fenceSyncKHR.createSyncKHR(
             eglGetCurrentDisplay(), EGL_SYNC_FENCE_KHR, NULL);
 
@@ -183,16 +268,16 @@ void GPUTimer::start()
 #else
     // ARBTimerQuery.
     if (m_type == ARBTimerQuery) {
-        m_timerQuery.queryCounter(m_timer[0], GL_TIMESTAMP);
+        m_timerQuery.queryCounter(m_timer[2 * index], GL_TIMESTAMP);
 
     // EXTTimerQuery.
     } else if (m_type == EXTTimerQuery) {
-        m_timerQuery.beginQuery(GL_TIME_ELAPSED, m_timer[0]);
+        m_timerQuery.beginQuery(GL_TIME_ELAPSED, m_timer[index]);
     }
 #endif
 }
 
-quint64 GPUTimer::stop()
+void GPUTimer::stop()
 {
     DASSERT(m_context == QOpenGLContext::currentContext());
     DASSERT(m_type != Unset);
@@ -202,9 +287,16 @@ quint64 GPUTimer::stop()
     m_started = false;
 #endif
 
+    const int index = (m_pendingIndex + m_pendingCount) % maxPendingTimings;
+    m_pendingCount++;
+
 #if defined(QT_OPENGL_ES)
+    // DisjointTimerQuery.
+    if (m_type == DisjointTimerQuery) {
+        m_disjointTimerQuery.queryCounterEXT(m_timer[2 * index + 1], GL_TIMESTAMP);
+
     // KHRFence.
-    if (m_type == KHRFence) {
+    } else if (m_type == KHRFence) {
         QElapsedTimer timer;
         EGLDisplay dpy = eglGetCurrentDisplay();
         EGLSyncKHR afterSync = m_fenceSyncKHR.createSyncKHR(dpy, EGL_SYNC_FENCE_KHR, NULL);
@@ -220,9 +312,9 @@ quint64 GPUTimer::stop()
         m_beforeSync = EGL_NO_SYNC_KHR;
         if (beforeSyncValue == EGL_CONDITION_SATISFIED_KHR
             && afterSyncValue == EGL_CONDITION_SATISFIED_KHR) {
-            return afterTime - beforeTime;
+            m_time[index] = afterTime - beforeTime;
         } else {
-            return 0;
+            m_time[index] = 0;
         }
 
     // NVFence.
@@ -233,27 +325,16 @@ quint64 GPUTimer::stop()
         quint64 beforeTime = timer.nsecsElapsed();
         m_fenceNV.finishFenceNV(m_fence[1]);
         quint64 afterTime = timer.nsecsElapsed();
-        return afterTime - beforeTime;
+        m_time[index] = afterTime - beforeTime;
     }
 #else
     // ARBTimerQuery.
     if (m_type == ARBTimerQuery) {
-        GLuint64 time[2] = { 0, 0 };
-        m_timerQuery.queryCounter(m_timer[1], GL_TIMESTAMP);
-        m_timerQuery.getQueryObjectui64v(m_timer[0], GL_QUERY_RESULT, &time[0]);
-        m_timerQuery.getQueryObjectui64v(m_timer[1], GL_QUERY_RESULT, &time[1]);
-        if (time[0] != 0 && time[1] != 0) {
-            return time[1] - time[0];
-        } else {
-            return -1;
-        }
+        m_timerQuery.queryCounter(m_timer[2 * index + 1], GL_TIMESTAMP);
 
     // EXTTimerQuery.
     } else if (m_type == EXTTimerQuery) {
-        GLuint64EXT time;
         m_timerQuery.endQuery(GL_TIME_ELAPSED);
-        m_timerQuery.getQueryObjectui64vExt(m_timer[0], GL_QUERY_RESULT, &time);
-        return time;
     }
 #endif
     // Finish.
@@ -262,9 +343,107 @@ quint64 GPUTimer::stop()
         QElapsedTimer timer;
         timer.start();
         functions->glFinish();
-        return static_cast<quint64>(timer.nsecsElapsed());
+        m_time[index] = static_cast<quint64>(timer.nsecsElapsed());
     }
+}
 
-    DNOT_REACHED();
-    return 0;
+bool GPUTimer::result(quint64* time, bool wait)
+{
+    DASSERT(m_context == QOpenGLContext::currentContext());
+    DASSERT(m_type != Unset);
+    DASSERT(m_pendingCount > 0);
+    DASSERT(time);
+
+    const int index = m_pendingIndex;
+
+    if (!isQueryBased()) {
+        *time = m_time[index];
+        discard();
+        return true;
+    }
+
+    // Invalidated by a disjoint operation.
+    if (m_invalidCount > 0) {
+        *time = 0;
+        discard();
+        return true;
+    }
+
+#if defined(QT_OPENGL_ES)
+    // DisjointTimerQuery. The timestamp queries being ended in order, the
+    // availability of the second one implies the availability of the first one.
+    quint64 available = 0;
+    m_disjointTimerQuery.getQueryObjectui64vEXT(
+        m_timer[2 * index + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available && !wait) {
+        return false;
+    }
+    quint64 timeStamp[2] = { 0, 0 };
+    m_disjointTimerQuery.getQueryObjectui64vEXT(m_timer[2 * index], GL_QUERY_RESULT, &timeStamp[0]);
+    m_disjointTimerQuery.getQueryObjectui64vEXT(
+        m_timer[2 * index + 1], GL_QUERY_RESULT, &timeStamp[1]);
+    *time = (timeStamp[1] > timeStamp[0]) ? timeStamp[1] - timeStamp[0] : 0;
+#else
+    // ARBTimerQuery.
+    if (m_type == ARBTimerQuery) {
+        GLuint64 available = 0;
+        m_timerQuery.getQueryObjectui64v(
+            m_timer[2 * index + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available && !wait) {
+            return false;
+        }
+        GLuint64 timeStamp[2] = { 0, 0 };
+        m_timerQuery.getQueryObjectui64v(m_timer[2 * index], GL_QUERY_RESULT, &timeStamp[0]);
+        m_timerQuery.getQueryObjectui64v(m_timer[2 * index + 1], GL_QUERY_RESULT, &timeStamp[1]);
+        *time = (timeStamp[0] != 0 && timeStamp[1] > timeStamp[0])
+            ? timeStamp[1] - timeStamp[0] : 0;
+
+    // EXTTimerQuery.
+    } else {
+        GLuint64EXT available = 0;
+        m_timerQuery.getQueryObjectui64vExt(m_timer[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available && !wait) {
+            return false;
+        }
+        GLuint64EXT elapsedTime = 0;
+        m_timerQuery.getQueryObjectui64vExt(m_timer[index], GL_QUERY_RESULT, &elapsedTime);
+        *time = elapsedTime;
+    }
+#endif
+
+    discard();
+    return true;
+}
+
+void GPUTimer::checkDisjoint()
+{
+    DASSERT(m_context == QOpenGLContext::currentContext());
+    DASSERT(m_type != Unset);
+
+#if defined(QT_OPENGL_ES)
+    // DisjointTimerQuery. A disjoint operation (like a GPU frequency change)
+    // makes the results of all the queries in flight invalid. The flag is
+    // cleared when read, so all the pending timings are dropped at once.
+    if (m_type == DisjointTimerQuery) {
+        GLint disjoint = 0;
+        QOpenGLContext::currentContext()->functions()->glGetIntegerv(
+            GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint) {
+            m_invalidCount = m_pendingCount;
+        }
+    }
+#endif
+}
+
+void GPUTimer::discard()
+{
+    DASSERT(m_pendingCount > 0);
+
+    // Queries don't need to be reset, a new start()/stop() pair overwrites
+    // their results.
+    m_pendingIndex = (m_pendingIndex + 1) % maxPendingTimings;
+    m_pendingCount--;
+    if (m_invalidCount > 0) {
+        m_invalidCount--;
+    }
 }
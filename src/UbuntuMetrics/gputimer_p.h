@@ -33,35 +33,63 @@
 // in the command buffer from the CPU, this timer pushes dedicated
 // synchronization commands to the command buffer, which the GPU signals
 // whenever completed. That allows to get accurate GPU timings.
+//
+// Timings are pipelined, up to maxPendingTimings start()/stop() pairs can be
+// in flight and their results are retrieved a few frames later, in the same
+// order, without stalling the calling thread. That's the case with timer
+// queries (GL_ARB_timer_query, GL_EXT_timer_query and
+// GL_EXT_disjoint_timer_query). Fence based and glFinish based timers still
+// have to wait for the GPU in stop(), their results are available right away.
 class UBUNTU_METRICS_PRIVATE_EXPORT GPUTimer
 {
 public:
+    static const int maxPendingTimings = 4;
+
     GPUTimer() :
 #if !defined QT_NO_DEBUG
         m_context(nullptr), m_started(false),
 #endif
-        m_type(Unset) {}
+        m_type(Unset), m_pendingIndex(0), m_pendingCount(0), m_invalidCount(0) {}
 
     // Allocates/Deletes the OpenGL resources. finalize() is not called at
     // destruction, it must be explicitly called to free the resources at the
     // right time in a thread with the same OpenGL context bound than at
-    // initialize().
+    // initialize(). Pending timings are discarded at finalization.
     void initialize();
     void finalize();
 
-    // Starts/Stops the timer. stop() returns the time elapsed in nanoseconds
-    // since the call to start(). Calling start()/stop() two times in a row
+    // Starts/Stops the timer. Calling start()/stop() two times in a row
     // triggers an assertion in debug builds and leads to undefined results in
-    // non-debug builds. Must be called in a thread with the same OpenGL context
-    // bound than at initialize().
+    // non-debug builds. start() must not be called when pendingCount() is
+    // maxPendingTimings, the oldest timing must be retrieved or discarded
+    // before. Must be called in a thread with the same OpenGL context bound
+    // than at initialize().
     void start();
-    quint64 stop();
+    void stop();
+
+    // Gets the time in nanoseconds elapsed between the oldest pending
+    // start()/stop() pair and removes it from the pending timings. Returns
+    // false if the result isn't available yet, unless wait is true in which
+    // case the GPU is waited for. The time is 0 if the result is
+    // invalid. discard() removes the oldest pending timing without retrieving
+    // it. Must be called in a thread with the same OpenGL context bound than at
+    // initialize().
+    bool result(quint64* time, bool wait = false);
+    void discard();
+    int pendingCount() const { return m_pendingCount; }
+
+    // Invalidates all the pending timings if a disjoint operation happened
+    // since the last check (GL_EXT_disjoint_timer_query only), their results
+    // are then 0. Must be called once before retrieving a set of results, in a
+    // thread with the same OpenGL context bound than at initialize().
+    void checkDisjoint();
 
 private:
     enum Type {
         Unset,
         Finish,
 #if defined(QT_OPENGL_ES)
+        DisjointTimerQuery,
         KHRFence,
         NVFence,
 #else
@@ -70,11 +98,19 @@ private:
 #endif
     };
 
+    bool isQueryBased() const;
+
 #if !defined QT_NO_DEBUG
     QOpenGLContext* m_context;
     bool m_started;
 #endif
     Type m_type;
+    int m_pendingIndex;
+    int m_pendingCount;
+    // Number of the oldest pending timings invalidated by a disjoint operation.
+    int m_invalidCount;
+    // Results of the timers waiting for the GPU in stop().
+    quint64 m_time[maxPendingTimings];
 
 #if defined(QT_OPENGL_ES)
     struct {
@@ -94,6 +130,17 @@ private:
     } m_fenceSyncKHR;
     EGLSyncKHR m_beforeSync;
 
+    struct {
+        void (QOPENGLF_APIENTRYP genQueriesEXT)(GLsizei n, GLuint* ids);
+        void (QOPENGLF_APIENTRYP deleteQueriesEXT)(GLsizei n, const GLuint* ids);
+        void (QOPENGLF_APIENTRYP queryCounterEXT)(GLuint id, GLenum target);
+        // quint64 since GLuint64 isn't defined by all the OpenGL ES 2 headers.
+        void (QOPENGLF_APIENTRYP getQueryObjectui64vEXT)(GLuint id, GLenum pname,
+                                                         quint64* params);
+    } m_disjointTimerQuery;
+    // Two timestamp queries per pending timing.
+    GLuint m_timer[2 * maxPendingTimings];
+
 #else
     struct {
         void (QOPENGLF_APIENTRYP genQueries)(GLsizei n, GLuint* ids);
@@ -105,7 +152,9 @@ private:
                                                          GLuint64EXT* params);
         void (QOPENGLF_APIENTRYP queryCounter)(GLuint id, GLenum target);
     } m_timerQuery;
-    GLuint m_timer[2];
+    // Two timestamp queries (ARB) or one time elapsed query (EXT) per pending
+    // timing.
+    GLuint m_timer[2 * maxPendingTimings];
 #endif
 };
 
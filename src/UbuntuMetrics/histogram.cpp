@@ -0,0 +1,87 @@
+// Copyright © 2016 Canonical Ltd.
+// Author: Loïc Molinari <loic.molinari@canonical.com>
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+#include "histogram_p.h"
+
+#include <string.h>
+
+void Histogram::reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_max = 0;
+}
+
+// static.
+int Histogram::bucketIndex(quint32 value)
+{
+    if (value < static_cast<quint32>(subBucketCount)) {
+        return value;
+    } else {
+        // The most significant bit gives the power-of-two range, the following
+        // (subBucketBits - 1) bits give the linear sub-bucket.
+        const int msb = 31 - __builtin_clz(value);
+        const int shift = msb - (subBucketBits - 1);
+        const int subBucket = (value >> shift) - subBucketHalfCount;
+        return subBucketCount + (msb - subBucketBits) * subBucketHalfCount + subBucket;
+    }
+}
+
+// static.
+quint32 Histogram::bucketValue(int index)
+{
+    DASSERT(index >= 0 && index < bucketCount);
+
+    if (index < subBucketCount) {
+        return index;
+    } else {
+        // Returns the middle of the range covered by the bucket.
+        const int range = (index - subBucketCount) / subBucketHalfCount;
+        const int subBucket = (index - subBucketCount) % subBucketHalfCount;
+        const int shift = range + 1;
+        const quint64 lowest = static_cast<quint64>(subBucketHalfCount + subBucket) << shift;
+        return static_cast<quint32>(qMin(lowest + ((1ull << shift) >> 1), 0xffffffffull));
+    }
+}
+
+void Histogram::record(quint32 value)
+{
+    m_buckets[bucketIndex(value)]++;
+    m_count++;
+    m_max = qMax(m_max, value);
+}
+
+quint32 Histogram::percentile(float percentage) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const quint64 target = qMax(static_cast<quint64>(1), static_cast<quint64>(
+        (qBound(0.0f, percentage, 100.0f) * m_count) / 100.0f + 0.5f));
+    if (target >= m_count) {
+        return m_max;
+    }
+    quint64 count = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        count += m_buckets[i];
+        if (count >= target) {
+            return qMin(bucketValue(i), m_max);
+        }
+    }
+    return m_max;
+}
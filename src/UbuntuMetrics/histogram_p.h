@@ -0,0 +1,58 @@
+// Copyright © 2016 Canonical Ltd.
+// Author: Loïc Molinari <loic.molinari@canonical.com>
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HISTOGRAM_P_H
+#define HISTOGRAM_P_H
+
+#include <UbuntuMetrics/private/ubuntumetricsglobal_p.h>
+
+// Histogram is a fixed memory, log-linear histogram in the spirit of HDR
+// histograms. Values below 2^subBucketBits are stored exactly, values above are
+// stored in buckets covering power-of-two ranges split in 2^(subBucketBits-1)
+// linear sub-buckets, giving a relative precision of around 3% over the whole
+// 32-bit range. Recording a value is a few bit operations and an increment.
+class UBUNTU_METRICS_PRIVATE_EXPORT Histogram
+{
+public:
+    static const int subBucketBits = 6;
+    static const int subBucketCount = 1 << subBucketBits;
+    static const int subBucketHalfCount = subBucketCount / 2;
+    static const int bucketCount =
+        subBucketCount + (32 - subBucketBits) * subBucketHalfCount;
+
+    Histogram() { reset(); }
+
+    void reset();
+    void record(quint32 value);
+
+    // Get the value below which the given percentage (in the range [0, 100])
+    // of the recorded values fall. Returns 0 if no values have been recorded.
+    quint32 percentile(float percentage) const;
+
+    quint32 count() const { return m_count; }
+    quint32 max() const { return m_max; }
+
+private:
+    static int bucketIndex(quint32 value);
+    static quint32 bucketValue(int index);
+
+    quint32 m_buckets[bucketCount];
+    quint32 m_count;
+    quint32 m_max;
+};
+
+#endif  // HISTOGRAM_P_H
@@ -18,10 +18,15 @@
 #include "logger_p.h"
 
 #include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
 
 #include <QtCore/QDir>
 #include <QtCore/QTime>
 
+#include "applicationmonitor_p.h"
 #include "events.h"
 #include "ubuntumetricsglobal_p.h"
 #if defined(Q_OS_LINUX)
@@ -30,12 +35,31 @@
 #include "lttng/lttng_p.h"
 #endif  // defined(Q_OS_LINUX)
 
+static bool writeBinaryTraceHeader(QFile* file)
+{
+    UMBinaryTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "UMTRACE", sizeof(header.magic));
+    header.version = UMBinaryTraceHeader::currentVersion;
+    header.eventSize = sizeof(UMEvent);
+    header.byteOrder = UMBinaryTraceHeader::byteOrderMark;
+    return file->write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+}
+
 UMFileLogger::UMFileLogger(const QString& fileName, bool parsable)
-    : d_ptr(new UMFileLoggerPrivate(fileName, parsable))
+    : d_ptr(new UMFileLoggerPrivate(fileName, parsable ? ParsableText : Text))
 {
 }
 
-UMFileLoggerPrivate::UMFileLoggerPrivate(const QString& fileName, bool parsable)
+UMFileLogger::UMFileLogger(const QString& fileName, Format format)
+    : d_ptr(new UMFileLoggerPrivate(fileName, format))
+{
+}
+
+UMFileLoggerPrivate::UMFileLoggerPrivate(const QString& fileName, UMFileLogger::Format format)
+    : m_binaryBuffer(nullptr)
+    , m_binaryFlushTimeStamp(0)
+    , m_binaryBufferCount(0)
 {
     if (QDir::isRelativePath(fileName)) {
         m_file.setFileName(QString(QDir::currentPath() + QDir::separator() + fileName));
@@ -43,20 +67,30 @@ UMFileLoggerPrivate::UMFileLoggerPrivate(const QString& fileName, bool parsable)
         m_file.setFileName(fileName);
     }
 
-    if (m_file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Unbuffered)) {
+    if (format == UMFileLogger::Binary) {
+        if (m_file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+            if (writeBinaryTraceHeader(&m_file)) {
+                m_binaryBuffer = static_cast<UMEvent*>(
+                    alignedAlloc(64, binaryBufferSize * sizeof(UMEvent)));
+                m_flags = Open | Binary;
+                return;
+            }
+        }
+    } else if (m_file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Unbuffered)) {
         m_textStream.setDevice(&m_file);
         m_textStream.setCodec("ISO 8859-1");
         m_textStream.setRealNumberPrecision(2);
         m_textStream.setRealNumberNotation(QTextStream::FixedNotation);
-        m_flags = Open | Parsable;
-        if (parsable) {
+        m_flags = Open;
+        if (format == UMFileLogger::ParsableText) {
             m_flags |= Parsable;
         }
-    } else {
-        m_flags = 0;
-        WARN("FileLogger: Can't open file %s '%s'.", fileName.toLatin1().constData(),
-             m_file.errorString().toLatin1().constData());
+        return;
     }
+
+    m_flags = 0;
+    WARN("FileLogger: Can't open file %s '%s'.", fileName.toLatin1().constData(),
+         m_file.errorString().toLatin1().constData());
 }
 
 UMFileLogger::UMFileLogger(FILE* fileHandle, bool parsable)
@@ -65,6 +99,9 @@ UMFileLogger::UMFileLogger(FILE* fileHandle, bool parsable)
 }
 
 UMFileLoggerPrivate::UMFileLoggerPrivate(FILE* fileHandle, bool parsable)
+    : m_binaryBuffer(nullptr)
+    , m_binaryFlushTimeStamp(0)
+    , m_binaryBufferCount(0)
 {
     if (m_file.open(fileHandle, QIODevice::WriteOnly | QIODevice::Text | QIODevice::Unbuffered)) {
         m_textStream.setDevice(&m_file);
@@ -92,6 +129,14 @@ UMFileLogger::~UMFileLogger()
     delete d_ptr;
 }
 
+UMFileLoggerPrivate::~UMFileLoggerPrivate()
+{
+    if (m_flags & Binary) {
+        writeBinary(nullptr, 0);
+        free(m_binaryBuffer);
+    }
+}
+
 bool UMFileLogger::isOpen()
 {
     return !!(d_func()->m_flags & UMFileLoggerPrivate::Open);
@@ -100,118 +145,282 @@ bool UMFileLogger::isOpen()
 // FIXME(loicm) We should maybe get rid of QTextStream and directly write to the
 //     device for efficiency reasons.
 
+void UMLogger::logBatch(const UMEvent* events, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        log(events[i]);
+    }
+}
+
 void UMFileLogger::log(const UMEvent& event)
 {
     d_func()->log(event);
 }
 
+void UMFileLogger::logBatch(const UMEvent* events, int count)
+{
+    d_func()->logBatch(events, count);
+}
+
+void UMFileLogger::flush()
+{
+    Q_D(UMFileLogger);
+    if (d->m_flags & UMFileLoggerPrivate::Binary) {
+        d->writeBinary(nullptr, 0);
+    }
+}
+
 void UMFileLoggerPrivate::log(const UMEvent& event)
 {
-    if (m_flags & Open) {
-        // ANSI/VT100 terminal codes.
-        const char* const dim = m_flags & Colored ? "\033[02m" : "";
-        const char* const reset = m_flags & Colored ? "\033[00m" : "";
-        const char* const dimColon = m_flags & Colored ? "\033[02m:\033[00m" : "=";
-
-        QTime timeStamp = QTime(0, 0).addMSecs(event.timeStamp / 1000000);
-        QString timeString = !timeStamp.hour()
-            ? timeStamp.toString(QStringLiteral("mm:ss:zzz"))
-            : timeStamp.toString(QStringLiteral("hh:mm:ss:zzz"));
-
-        switch (event.type) {
-        case UMEvent::Process: {
-            if (m_flags & Parsable) {
-                m_textStream
-                    << "P "
-                    << event.timeStamp << ' '
-                    << event.process.cpuUsage << ' '
-                    << event.process.vszMemory << ' '
-                    << event.process.rssMemory << ' '
-                    << event.process.threadCount << '\n' << flush;
-            } else {
-                m_textStream
-                    << (m_flags & Colored ? "\033[33mP\033[00m " : "P ")
-                    << dim << timeString << reset << ' '
-                    << "CPU" << dimColon << event.process.cpuUsage << "% "
-                    << "VSZ" << dimColon << event.process.vszMemory << "kB "
-                    << "RSS" << dimColon << event.process.rssMemory << "kB "
-                    << "Threads" << dimColon << event.process.threadCount
-                    << '\n' << flush;
-            }
-            break;
+    if (m_flags & Binary) {
+        DASSERT(m_flags & Open);
+        logBinary(&event, 1);
+    } else if (m_flags & Open) {
+        logText(event);
+        m_textStream.flush();
+    }
+}
+
+void UMFileLoggerPrivate::logBatch(const UMEvent* events, int count)
+{
+    DASSERT(count > 0);
+
+    if (m_flags & Binary) {
+        DASSERT(m_flags & Open);
+        logBinary(events, count);
+    } else if (m_flags & Open) {
+        // Flush once per batch so that the whole text goes in a single write.
+        for (int i = 0; i < count; ++i) {
+            logText(events[i]);
         }
+        m_textStream.flush();
+    }
+}
 
-        case UMEvent::Frame:
-            if (m_flags & Parsable) {
-                m_textStream
-                    << "F "
-                    << event.timeStamp << ' '
-                    << event.frame.window << ' '
-                    << event.frame.number << ' '
-                    << event.frame.deltaTime << ' '
-                    << event.frame.syncTime << ' '
-                    << event.frame.renderTime << ' '
-                    << event.frame.gpuTime << ' '
-                    << event.frame.swapTime << '\n' << flush;
-            } else {
-                m_textStream
-                    << (m_flags & Colored ? "\033[36mF\033[00m " : "F ")
-                    << dim << timeString << reset << ' '
-                    << "Win" << dimColon << event.frame.window << ' '
-                    << "N" << dimColon << event.frame.number << ' '
-                    << "Delta" << dimColon << event.frame.deltaTime / 1000000.0f << "ms "
-                    << "Sync" << dimColon << event.frame.syncTime / 1000000.0f << "ms "
-                    << "Render" << dimColon << event.frame.renderTime / 1000000.0f << "ms "
-                    << "GPU" << dimColon << event.frame.gpuTime / 1000000.0f << "ms "
-                    << "Swap" << dimColon << event.frame.swapTime / 1000000.0f << "ms\n" << flush;
-            }
-            break;
+void UMFileLoggerPrivate::logBinary(const UMEvent* events, int count)
+{
+    DASSERT(m_flags & Binary);
+    DASSERT(count > 0);
+    DASSERT(m_binaryBufferCount < binaryBufferSize);
+
+    // Write when the buffer is full or regularly enough so that a trace is
+    // still useful if the application crashes. Batches not fitting in the
+    // buffer are written directly along with the buffered events.
+    const quint64 timeStamp = events[count - 1].timeStamp;
+    if (m_binaryBufferCount + count <= binaryBufferSize) {
+        memcpy(&m_binaryBuffer[m_binaryBufferCount], events, count * sizeof(UMEvent));
+        m_binaryBufferCount += count;
+        if (m_binaryBufferCount == binaryBufferSize
+            || timeStamp - m_binaryFlushTimeStamp >= binaryFlushInterval) {
+            writeBinary(nullptr, 0);
+            m_binaryFlushTimeStamp = timeStamp;
+        }
+    } else {
+        writeBinary(events, count);
+        m_binaryFlushTimeStamp = timeStamp;
+    }
+}
 
-        case UMEvent::Window: {
-            if (m_flags & Parsable) {
-                m_textStream
-                    << "W "
-                    << event.timeStamp << ' '
-                    << event.window.id << ' '
-                    << event.window.state << ' '
-                    << event.window.width << ' '
-                    << event.window.height << '\n' << flush;
-            } else {
-                const char* const stateString[] = { "Hidden", "Shown", "Resized" };
-                Q_STATIC_ASSERT(ARRAY_SIZE(stateString) == UMWindowEvent::StateCount);
-                m_textStream
-                    << (m_flags & Colored ? "\033[35mW\033[00m " : "W ")
-                    << dim << timeString << reset << ' '
-                    << "Id" << dimColon << event.window.id << ' '
-                    << "State" << dimColon << stateString[event.window.state] << ' '
-                    << "Size" << dimColon << event.window.width << 'x' << event.window.height
-                    << '\n' << flush;
+void UMFileLoggerPrivate::writeBinary(const UMEvent* events, int count)
+{
+    DASSERT(m_flags & Binary);
+
+    // The buffered events and the given ones are written with a single
+    // writev() call. The header being written at opening, the file descriptor
+    // is used directly from then on.
+    struct iovec vectors[2];
+    int vectorCount = 0;
+    ssize_t size = 0;
+    if (m_binaryBufferCount > 0) {
+        vectors[vectorCount].iov_base = m_binaryBuffer;
+        vectors[vectorCount].iov_len = m_binaryBufferCount * sizeof(UMEvent);
+        size += vectors[vectorCount++].iov_len;
+    }
+    if (count > 0) {
+        vectors[vectorCount].iov_base = const_cast<UMEvent*>(events);
+        vectors[vectorCount].iov_len = count * sizeof(UMEvent);
+        size += vectors[vectorCount++].iov_len;
+    }
+    // writev() can write less than requested (signal, full disk, pipe), the
+    // remainder is written until everything is written or an error occurs so
+    // that events are never truncated.
+    struct iovec* vector = vectors;
+    while (size > 0) {
+        const ssize_t written = writev(m_file.handle(), vector, vectorCount);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) {
+                continue;
             }
+            WARN("FileLogger: Can't write to file '%s'.",
+                 written < 0 ? strerror(errno) : "nothing written");
             break;
         }
+        size -= written;
+        size_t remaining = written;
+        while (vectorCount > 0 && remaining >= vector->iov_len) {
+            remaining -= vector->iov_len;
+            vector++;
+            vectorCount--;
+        }
+        if (vectorCount > 0) {
+            vector->iov_base = static_cast<char*>(vector->iov_base) + remaining;
+            vector->iov_len -= remaining;
+        }
+    }
+    m_binaryBufferCount = 0;
+}
 
-        case UMEvent::Generic: {
-            if (m_flags & Parsable) {
-                m_textStream
-                    << "G "
-                    << event.timeStamp << ' '
-                    << event.generic.id << ' '
-                    << event.generic.string << '\n' << flush;
-            } else {
-                m_textStream
-                    << (m_flags & Colored ? "\033[32mG\033[00m " : "G ")
-                    << dim << timeString << reset << ' '
-                    << "Id" << dimColon << event.generic.id << ' '
-                    << "String" << dimColon << '"' << event.generic.string << '"'
-                    << '\n' << flush;
-            }
-            break;
+void UMFileLoggerPrivate::logText(const UMEvent& event)
+{
+    DASSERT(m_flags & Open);
+
+    // ANSI/VT100 terminal codes.
+    const char* const dim = m_flags & Colored ? "\033[02m" : "";
+    const char* const reset = m_flags & Colored ? "\033[00m" : "";
+    const char* const dimColon = m_flags & Colored ? "\033[02m:\033[00m" : "=";
+
+    QTime timeStamp = QTime(0, 0).addMSecs(event.timeStamp / 1000000);
+    QString timeString = !timeStamp.hour()
+        ? timeStamp.toString(QStringLiteral("mm:ss:zzz"))
+        : timeStamp.toString(QStringLiteral("hh:mm:ss:zzz"));
+
+    switch (event.type) {
+    case UMEvent::Process: {
+        if (m_flags & Parsable) {
+            m_textStream
+                << "P "
+                << event.timeStamp << ' '
+                << event.process.cpuUsage << ' '
+                << event.process.vszMemory << ' '
+                << event.process.rssMemory << ' '
+                << event.process.threadCount << ' '
+                << event.process.pssMemory << ' '
+                << event.process.swapMemory << ' '
+                << event.process.voluntaryContextSwitches << ' '
+                << event.process.involuntaryContextSwitches << ' '
+                << event.process.minorPageFaults << ' '
+                << event.process.majorPageFaults << '\n';
+        } else {
+            m_textStream
+                << (m_flags & Colored ? "\033[33mP\033[00m " : "P ")
+                << dim << timeString << reset << ' '
+                << "CPU" << dimColon << event.process.cpuUsage << "% "
+                << "VSZ" << dimColon << event.process.vszMemory << "kB "
+                << "RSS" << dimColon << event.process.rssMemory << "kB "
+                << "PSS" << dimColon << event.process.pssMemory << "kB "
+                << "Swap" << dimColon << event.process.swapMemory << "kB "
+                << "Threads" << dimColon << event.process.threadCount << ' '
+                << "CSw" << dimColon << event.process.voluntaryContextSwitches << '/'
+                << event.process.involuntaryContextSwitches << ' '
+                << "Faults" << dimColon << event.process.minorPageFaults << '/'
+                << event.process.majorPageFaults
+                << '\n';
         }
+        break;
+    }
 
-        default:
-            DNOT_REACHED();
-            break;
+    case UMEvent::Frame:
+        if (m_flags & Parsable) {
+            m_textStream
+                << "F "
+                << event.timeStamp << ' '
+                << event.frame.window << ' '
+                << event.frame.number << ' '
+                << event.frame.deltaTime << ' '
+                << event.frame.syncTime << ' '
+                << event.frame.renderTime << ' '
+                << event.frame.gpuTime << ' '
+                << event.frame.swapTime << ' '
+                << event.frame.polishTime << ' '
+                << event.frame.guiTime << '\n';
+        } else {
+            m_textStream
+                << (m_flags & Colored ? "\033[36mF\033[00m " : "F ")
+                << dim << timeString << reset << ' '
+                << "Win" << dimColon << event.frame.window << ' '
+                << "N" << dimColon << event.frame.number << ' '
+                << "Delta" << dimColon << event.frame.deltaTime / 1000000.0f << "ms "
+                << "GUI" << dimColon << event.frame.guiTime / 1000000.0f << "ms "
+                << "Polish" << dimColon << event.frame.polishTime / 1000000.0f << "ms "
+                << "Sync" << dimColon << event.frame.syncTime / 1000000.0f << "ms "
+                << "Render" << dimColon << event.frame.renderTime / 1000000.0f << "ms "
+                << "GPU" << dimColon << event.frame.gpuTime / 1000000.0f << "ms "
+                << "Swap" << dimColon << event.frame.swapTime / 1000000.0f << "ms\n";
+        }
+        break;
+
+    case UMEvent::Window: {
+        if (m_flags & Parsable) {
+            m_textStream
+                << "W "
+                << event.timeStamp << ' '
+                << event.window.id << ' '
+                << event.window.state << ' '
+                << event.window.width << ' '
+                << event.window.height << '\n';
+        } else {
+            const char* const stateString[] = { "Hidden", "Shown", "Resized" };
+            Q_STATIC_ASSERT(ARRAY_SIZE(stateString) == UMWindowEvent::StateCount);
+            m_textStream
+                << (m_flags & Colored ? "\033[35mW\033[00m " : "W ")
+                << dim << timeString << reset << ' '
+                << "Id" << dimColon << event.window.id << ' '
+                << "State" << dimColon << stateString[event.window.state] << ' '
+                << "Size" << dimColon << event.window.width << 'x' << event.window.height
+                << '\n';
         }
+        break;
+    }
+
+    case UMEvent::Generic: {
+        if (m_flags & Parsable) {
+            m_textStream
+                << "G "
+                << event.timeStamp << ' '
+                << event.generic.id << ' '
+                << event.generic.string << '\n';
+        } else {
+            m_textStream
+                << (m_flags & Colored ? "\033[32mG\033[00m " : "G ")
+                << dim << timeString << reset << ' '
+                << "Id" << dimColon << event.generic.id << ' '
+                << "String" << dimColon << '"' << event.generic.string << '"'
+                << '\n';
+        }
+        break;
+    }
+
+    case UMEvent::Thread: {
+        const char* const roleString[] = { "Unknown", "GUI", "Render", "Logging", "QMLWorker" };
+        Q_STATIC_ASSERT(ARRAY_SIZE(roleString) == UMThreadEvent::RoleCount);
+        if (m_flags & Parsable) {
+            m_textStream
+                << "T "
+                << event.timeStamp << ' '
+                << event.thread.id << ' '
+                << event.thread.role << ' '
+                << event.thread.cpuUsage << ' '
+                << event.thread.userTime << ' '
+                << event.thread.systemTime << ' '
+                << event.thread.name << '\n';
+        } else {
+            m_textStream
+                << (m_flags & Colored ? "\033[34mT\033[00m " : "T ")
+                << dim << timeString << reset << ' '
+                << "Id" << dimColon << event.thread.id << ' '
+                << "Role" << dimColon << roleString[event.thread.role] << ' '
+                << "Name" << dimColon << '"' << event.thread.name << '"' << ' '
+                << "CPU" << dimColon << event.thread.cpuUsage << "% "
+                << "User" << dimColon << event.thread.userTime / 1000.0f << "ms "
+                << "System" << dimColon << event.thread.systemTime / 1000.0f << "ms"
+                << '\n';
+        }
+        break;
+    }
+
+    default:
+        DNOT_REACHED();
+        break;
     }
 }
 
@@ -231,6 +440,305 @@ bool UMFileLogger::parsable()
     return !!(d_func()->m_flags & UMFileLoggerPrivate::Parsable);
 }
 
+UMFileLogger::Format UMFileLogger::format()
+{
+    Q_D(UMFileLogger);
+
+    if (d->m_flags & UMFileLoggerPrivate::Binary) {
+        return Binary;
+    } else {
+        return (d->m_flags & UMFileLoggerPrivate::Parsable) ? ParsableText : Text;
+    }
+}
+
+UMFlightRecorder::UMFlightRecorder(const QString& fileName, int duration, int maxEventCount)
+    : d_ptr(new UMFlightRecorderPrivate(fileName, duration, maxEventCount))
+{
+}
+
+UMFlightRecorderPrivate::UMFlightRecorderPrivate(
+    const QString& fileName, int duration, int maxEventCount)
+    : m_duration(static_cast<quint64>(qMax(0, duration)) * 1000000)
+    , m_lastDumpTimeStamp(0)
+    , m_jankThreshold(-1)
+    , m_dumpRequested(0)
+    , m_dumpCount(0)
+    , m_ringSize(qMax(1, maxEventCount))
+    , m_ringIndex(0)
+    , m_ringCount(0)
+{
+    if (QDir::isRelativePath(fileName)) {
+        m_fileName = QDir::currentPath() + QDir::separator() + fileName;
+    } else {
+        m_fileName = fileName;
+    }
+
+    // Allocated once, logging an event is then a copy in the ring.
+    m_ring = static_cast<UMEvent*>(alignedAlloc(64, m_ringSize * sizeof(UMEvent)));
+}
+
+UMFlightRecorder::~UMFlightRecorder()
+{
+    delete d_ptr;
+}
+
+UMFlightRecorderPrivate::~UMFlightRecorderPrivate()
+{
+    free(m_ring);
+}
+
+void UMFlightRecorder::log(const UMEvent& event)
+{
+    d_func()->log(&event, 1);
+}
+
+void UMFlightRecorder::logBatch(const UMEvent* events, int count)
+{
+    d_func()->log(events, count);
+}
+
+void UMFlightRecorderPrivate::log(const UMEvent* events, int count)
+{
+    const int jankThreshold = m_jankThreshold.load();
+    for (int i = 0; i < count; ++i) {
+        const UMEvent& event = events[i];
+        memcpy(&m_ring[m_ringIndex], &event, sizeof(UMEvent));
+        m_ringIndex = (m_ringIndex + 1) % m_ringSize;
+        m_ringCount = qMin(m_ringCount + 1, m_ringSize);
+
+        if (jankThreshold >= 0 && event.type == UMEvent::Frame
+            && (event.frame.guiTime + event.frame.syncTime + event.frame.renderTime
+                + event.frame.swapTime)
+                >= static_cast<quint64>(jankThreshold) * 1000000
+            // Signed delta, frame events can arrive late with a time stamp
+            // older than the last dump (GPU timer results are pipelined).
+            && (m_dumpCount.load() == 0
+                || static_cast<qint64>(event.timeStamp - m_lastDumpTimeStamp)
+                    >= static_cast<qint64>(m_duration))) {
+            m_dumpRequested.store(1);
+        }
+    }
+
+    dumpIfRequested();
+}
+
+void UMFlightRecorderPrivate::dumpIfRequested()
+{
+    // The request is kept until there's something to dump.
+    if (m_ringCount > 0 && m_dumpRequested.load() && m_dumpRequested.testAndSetRelaxed(1, 0)) {
+        dump();
+    }
+}
+
+void UMFlightRecorderPrivate::dump()
+{
+    DASSERT(m_ringCount > 0);
+
+    // Skip the events older than the covered duration.
+    const int newestIndex = (m_ringIndex + m_ringSize - 1) % m_ringSize;
+    const quint64 newestTimeStamp = m_ring[newestIndex].timeStamp;
+    const quint64 oldestTimeStamp =
+        newestTimeStamp > m_duration ? newestTimeStamp - m_duration : 0;
+    int index = (m_ringIndex + m_ringSize - m_ringCount) % m_ringSize;
+    int count = m_ringCount;
+    while (count > 1 && m_ring[index].timeStamp < oldestTimeStamp) {
+        index = (index + 1) % m_ringSize;
+        count--;
+    }
+
+    QFile file(QStringLiteral("%1.%2").arg(m_fileName).arg(m_dumpCount.load() + 1));
+    if (!file.open(QIODevice::WriteOnly) || !writeBinaryTraceHeader(&file)) {
+        WARN("FlightRecorder: Can't write file %s '%s'.", file.fileName().toLatin1().constData(),
+             file.errorString().toLatin1().constData());
+        return;
+    }
+
+    // The events to dump are split in two parts if the ring wraps around.
+    const int firstCount = qMin(count, m_ringSize - index);
+    const qint64 firstSize = firstCount * sizeof(UMEvent);
+    const qint64 secondSize = (count - firstCount) * sizeof(UMEvent);
+    if (file.write(reinterpret_cast<const char*>(&m_ring[index]), firstSize) != firstSize
+        || (secondSize > 0
+            && file.write(reinterpret_cast<const char*>(m_ring), secondSize) != secondSize)
+        || !file.flush()) {
+        WARN("FlightRecorder: Can't write file %s '%s'.", file.fileName().toLatin1().constData(),
+             file.errorString().toLatin1().constData());
+        // Don't leave a truncated trace behind.
+        file.remove();
+        return;
+    }
+
+    m_lastDumpTimeStamp = newestTimeStamp;
+    m_dumpCount.ref();
+}
+
+void UMFlightRecorder::flush()
+{
+    d_func()->dumpIfRequested();
+}
+
+void UMFlightRecorder::requestDump()
+{
+    d_func()->m_dumpRequested.store(1);
+    // Logged events are the only other trigger, an idle application would
+    // never dump.
+    UMApplicationMonitorPrivate::flushLoggers();
+}
+
+void UMFlightRecorder::setJankThreshold(int threshold)
+{
+    d_func()->m_jankThreshold.store(qMax(-1, threshold));
+}
+
+int UMFlightRecorder::jankThreshold()
+{
+    return d_func()->m_jankThreshold.load();
+}
+
+int UMFlightRecorder::dumpCount()
+{
+    return d_func()->m_dumpCount.load();
+}
+
+UMFrameSummaryLogger::UMFrameSummaryLogger(UMLogger* logger, int interval)
+    : d_ptr(new UMFrameSummaryLoggerPrivate(logger, interval))
+{
+}
+
+UMFrameSummaryLoggerPrivate::UMFrameSummaryLoggerPrivate(UMLogger* logger, int interval)
+    : m_logger(logger)
+    , m_interval(static_cast<quint64>(qMax(1, interval)) * 1000000)
+    , m_summaryTimeStamp(0)
+    , m_eventId(UMApplicationMonitorPrivate::registerGenericEvent())
+{
+    DASSERT(logger);
+}
+
+UMFrameSummaryLogger::~UMFrameSummaryLogger()
+{
+    delete d_ptr;
+}
+
+UMFrameSummaryLoggerPrivate::~UMFrameSummaryLoggerPrivate()
+{
+    qDeleteAll(m_windows);
+    delete m_logger;
+}
+
+bool UMFrameSummaryLogger::isOpen()
+{
+    return d_func()->m_logger->isOpen();
+}
+
+quint32 UMFrameSummaryLogger::eventId()
+{
+    return d_func()->m_eventId;
+}
+
+void UMFrameSummaryLogger::log(const UMEvent& event)
+{
+    d_func()->log(&event, 1);
+}
+
+void UMFrameSummaryLogger::logBatch(const UMEvent* events, int count)
+{
+    d_func()->log(events, count);
+}
+
+void UMFrameSummaryLogger::flush()
+{
+    d_func()->m_logger->flush();
+}
+
+void UMFrameSummaryLoggerPrivate::log(const UMEvent* events, int count)
+{
+    DASSERT(count > 0);
+
+    // Non-frame events are forwarded by runs of consecutive events.
+    int runStart = 0;
+    for (int i = 0; i < count; ++i) {
+        if (events[i].type == UMEvent::Frame) {
+            if (i > runStart) {
+                m_logger->logBatch(&events[runStart], i - runStart);
+            }
+            runStart = i + 1;
+            recordFrame(events[i]);
+        }
+    }
+    if (count > runStart) {
+        m_logger->logBatch(&events[runStart], count - runStart);
+    }
+
+    // Signed delta, frame events can arrive late with an older time stamp.
+    const quint64 timeStamp = events[count - 1].timeStamp;
+    if (m_summaryTimeStamp == 0) {
+        m_summaryTimeStamp = timeStamp;
+    } else if (static_cast<qint64>(timeStamp - m_summaryTimeStamp)
+               >= static_cast<qint64>(m_interval)) {
+        logSummaries(timeStamp);
+        m_summaryTimeStamp = timeStamp;
+    }
+}
+
+void UMFrameSummaryLoggerPrivate::recordFrame(const UMEvent& event)
+{
+    WindowHistograms* windowHistograms = nullptr;
+    const int windowCount = m_windows.size();
+    for (int i = 0; i < windowCount; ++i) {
+        if (m_windows[i]->window == event.frame.window) {
+            windowHistograms = m_windows[i];
+            break;
+        }
+    }
+    if (!windowHistograms) {
+        windowHistograms = new WindowHistograms;
+        windowHistograms->window = event.frame.window;
+        m_windows.append(windowHistograms);
+    }
+
+    // Recorded in microseconds.
+    Histogram* histograms = windowHistograms->histograms;
+    histograms[DeltaTime].record(qMin(event.frame.deltaTime / 1000, 0xffffffffull));
+    histograms[PolishTime].record(qMin(event.frame.polishTime / 1000, 0xffffffffull));
+    histograms[GuiTime].record(qMin(event.frame.guiTime / 1000, 0xffffffffull));
+    histograms[SyncTime].record(qMin(event.frame.syncTime / 1000, 0xffffffffull));
+    histograms[RenderTime].record(qMin(event.frame.renderTime / 1000, 0xffffffffull));
+    histograms[GpuTime].record(qMin(event.frame.gpuTime / 1000, 0xffffffffull));
+    histograms[SwapTime].record(qMin(event.frame.swapTime / 1000, 0xffffffffull));
+}
+
+void UMFrameSummaryLoggerPrivate::logSummaries(quint64 timeStamp)
+{
+    const char* const metricString[] = {
+        "delta", "polish", "gui", "sync", "render", "gpu", "swap"
+    };
+    Q_STATIC_ASSERT(ARRAY_SIZE(metricString) == MetricCount);
+
+    UMEvent events[MetricCount];
+    const int windowCount = m_windows.size();
+    for (int i = 0; i < windowCount; ++i) {
+        Histogram* histograms = m_windows[i]->histograms;
+        if (histograms[0].count() == 0) {
+            continue;
+        }
+        for (int j = 0; j < MetricCount; ++j) {
+            UMEvent& event = events[j];
+            event.type = UMEvent::Generic;
+            event.timeStamp = timeStamp;
+            event.generic.id = m_eventId;
+            const int size = snprintf(
+                event.generic.string, UMGenericEvent::maxStringSize, "FS %u %s %u %u %u %u %u",
+                m_windows[i]->window, metricString[j], histograms[j].count(),
+                histograms[j].percentile(50.0f), histograms[j].percentile(90.0f),
+                histograms[j].percentile(99.0f), histograms[j].max());
+            event.generic.stringSize =
+                qMin(size + 1, static_cast<int>(UMGenericEvent::maxStringSize));
+            histograms[j].reset();
+        }
+        m_logger->logBatch(events, MetricCount);
+    }
+}
+
 #if defined(Q_OS_LINUX)
 
 UMLTTNGPlugin* UMLTTNGLogger::m_plugin = nullptr;
@@ -264,61 +772,99 @@ UMLTTNGLogger::UMLTTNGLogger()
     }
 }
 
-void UMLTTNGLogger::log(const UMEvent& event)
+static void logLTTNGEvent(UMLTTNGPlugin* plugin, const UMEvent& event)
 {
-    if (Q_LIKELY(m_plugin)) {
-        switch (event.type) {
-
-        case UMEvent::Process: {
-            UMLTTNGProcessEvent processEvent = {
-                .vszMemory = event.process.vszMemory,
-                .rssMemory = event.process.rssMemory,
-                .cpuUsage = event.process.cpuUsage,
-                .threadCount = event.process.threadCount
-            };
-            m_plugin->logProcessEvent(&processEvent);
-            break;
-        }
+    switch (event.type) {
+
+    case UMEvent::Process: {
+        UMLTTNGProcessEvent processEvent = {
+            .vszMemory = event.process.vszMemory,
+            .rssMemory = event.process.rssMemory,
+            .cpuUsage = event.process.cpuUsage,
+            .threadCount = event.process.threadCount,
+            .pssMemory = event.process.pssMemory,
+            .swapMemory = event.process.swapMemory,
+            .voluntaryContextSwitches = event.process.voluntaryContextSwitches,
+            .involuntaryContextSwitches = event.process.involuntaryContextSwitches,
+            .minorPageFaults = event.process.minorPageFaults,
+            .majorPageFaults = event.process.majorPageFaults
+        };
+        plugin->logProcessEvent(&processEvent);
+        break;
+    }
 
-        case UMEvent::Frame: {
-            UMLTTNGFrameEvent frameEvent = {
-                .window = event.frame.window,
-                .number = event.frame.number,
-                .deltaTime = event.frame.deltaTime * 0.000001f,
-                .syncTime = event.frame.syncTime * 0.000001f,
-                .renderTime = event.frame.renderTime * 0.000001f,
-                .gpuTime = event.frame.gpuTime * 0.000001f,
-                .swapTime = event.frame.swapTime * 0.000001f
-            };
-            m_plugin->logFrameEvent(&frameEvent);
-            break;
-        }
+    case UMEvent::Frame: {
+        UMLTTNGFrameEvent frameEvent = {
+            .window = event.frame.window,
+            .number = event.frame.number,
+            .deltaTime = event.frame.deltaTime * 0.000001f,
+            .syncTime = event.frame.syncTime * 0.000001f,
+            .renderTime = event.frame.renderTime * 0.000001f,
+            .gpuTime = event.frame.gpuTime * 0.000001f,
+            .swapTime = event.frame.swapTime * 0.000001f,
+            .polishTime = event.frame.polishTime * 0.000001f,
+            .guiTime = event.frame.guiTime * 0.000001f
+        };
+        plugin->logFrameEvent(&frameEvent);
+        break;
+    }
 
-        case UMEvent::Window: {
-            const char* stateString[] = { "Hidden", "Shown", "Resized" };
-            Q_STATIC_ASSERT(ARRAY_SIZE(stateString) == UMWindowEvent::StateCount);
-            UMLTTNGWindowEvent windowEvent = {
-                .state = stateString[event.window.state],
-                .id = event.window.id,
-                .width = event.window.width,
-                .height = event.window.height
-            };
-            m_plugin->logWindowEvent(&windowEvent);
-            break;
-        }
+    case UMEvent::Window: {
+        const char* stateString[] = { "Hidden", "Shown", "Resized" };
+        Q_STATIC_ASSERT(ARRAY_SIZE(stateString) == UMWindowEvent::StateCount);
+        UMLTTNGWindowEvent windowEvent = {
+            .state = stateString[event.window.state],
+            .id = event.window.id,
+            .width = event.window.width,
+            .height = event.window.height
+        };
+        plugin->logWindowEvent(&windowEvent);
+        break;
+    }
 
-        case UMEvent::Generic: {
-            UMLTTNGGenericEvent genericEvent;
-            genericEvent.id = event.generic.id;
-            DASSERT(event.generic.stringSize < UMGenericEvent::maxStringSize);
-            memcpy(genericEvent.string, event.generic.string, event.generic.stringSize);
-            m_plugin->logGenericEvent(&genericEvent);
-            break;
-        }
+    case UMEvent::Generic: {
+        UMLTTNGGenericEvent genericEvent;
+        genericEvent.id = event.generic.id;
+        DASSERT(event.generic.stringSize < UMGenericEvent::maxStringSize);
+        memcpy(genericEvent.string, event.generic.string, event.generic.stringSize);
+        plugin->logGenericEvent(&genericEvent);
+        break;
+    }
 
-        default:
-            DNOT_REACHED();
-            break;
+    case UMEvent::Thread: {
+        const char* roleString[] = { "Unknown", "GUI", "Render", "Logging", "QMLWorker" };
+        Q_STATIC_ASSERT(ARRAY_SIZE(roleString) == UMThreadEvent::RoleCount);
+        UMLTTNGThreadEvent threadEvent;
+        threadEvent.role = roleString[event.thread.role];
+        threadEvent.id = event.thread.id;
+        threadEvent.userTime = event.thread.userTime;
+        threadEvent.systemTime = event.thread.systemTime;
+        threadEvent.cpuUsage = event.thread.cpuUsage;
+        memcpy(threadEvent.name, event.thread.name, UMThreadEvent::maxNameSize);
+        plugin->logThreadEvent(&threadEvent);
+        break;
+    }
+
+    default:
+        DNOT_REACHED();
+        break;
+    }
+}
+
+void UMLTTNGLogger::log(const UMEvent& event)
+{
+    if (Q_LIKELY(m_plugin)) {
+        logLTTNGEvent(m_plugin, event);
+    }
+}
+
+void UMLTTNGLogger::logBatch(const UMEvent* events, int count)
+{
+    // Tracepoints are written to per-CPU lock-free ring buffers by lttng-ust,
+    // batching here simply avoids the virtual call and checks per event.
+    if (Q_LIKELY(m_plugin)) {
+        for (int i = 0; i < count; ++i) {
+            logLTTNGEvent(m_plugin, events[i]);
         }
     }
 }
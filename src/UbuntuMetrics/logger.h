@@ -23,6 +23,8 @@
 #include <UbuntuMetrics/ubuntumetricsglobal.h>
 
 class UMFileLoggerPrivate;
+class UMFlightRecorderPrivate;
+class UMFrameSummaryLoggerPrivate;
 struct UMLTTNGPlugin;
 struct UMEvent;
 
@@ -35,6 +37,14 @@ public:
     // Log events.
     virtual void log(const UMEvent& event) = 0;
 
+    // Log a batch of count events. The default implementation calls log() for
+    // each event, loggers can reimplement it to reduce the number of writes.
+    virtual void logBatch(const UMEvent* events, int count);
+
+    // Write pending data. Called by the logging thread when it's woken up with
+    // no events to log (see UMFlightRecorder::requestDump()).
+    virtual void flush() {}
+
     // Get whether the target device has been opened successfully or not.
     virtual bool isOpen() = 0;
 };
@@ -43,21 +53,102 @@ public:
 class UBUNTU_METRICS_EXPORT UMFileLogger : public UMLogger
 {
 public:
+    enum Format {
+        // Human readable text.
+        Text = 0,
+        // Text with one space separated event per line.
+        ParsableText = 1,
+        // Versioned binary format storing raw UMEvents after a small header,
+        // buffered and appended to the file with a single write. Binary traces
+        // can be converted to text using the umtracedecoder tool.
+        Binary = 2
+    };
+
     UMFileLogger(const QString& filename, bool parsable = true);
+    UMFileLogger(const QString& filename, Format format);
     UMFileLogger(FILE* fileHandle, bool parsable = false);
     ~UMFileLogger();
 
     void log(const UMEvent& event) Q_DECL_OVERRIDE;
+    void logBatch(const UMEvent* events, int count) Q_DECL_OVERRIDE;
+    void flush() Q_DECL_OVERRIDE;
     bool isOpen() Q_DECL_OVERRIDE;
 
+    // Set whether text is parsable or not. Ignored by binary loggers.
     void setParsable(bool parsable);
     bool parsable();
 
+    // Get the format of the logger.
+    Format format();
+
 private:
     UMFileLoggerPrivate* const d_ptr;
     Q_DECLARE_PRIVATE(UMFileLogger)
 };
 
+// Keep the events logged during the last seconds in a preallocated in-memory
+// ring without doing any I/O. The ring can be dumped on request to a binary
+// trace (see UMFileLogger::Binary) named after the given file name followed by
+// the dump number.
+class UBUNTU_METRICS_EXPORT UMFlightRecorder : public UMLogger
+{
+public:
+    // duration is the time in milliseconds covered by a dump and maxEventCount
+    // the number of events the ring can hold.
+    UMFlightRecorder(const QString& fileName, int duration = 10000, int maxEventCount = 4096);
+    ~UMFlightRecorder();
+
+    void log(const UMEvent& event) Q_DECL_OVERRIDE;
+    void logBatch(const UMEvent* events, int count) Q_DECL_OVERRIDE;
+    void flush() Q_DECL_OVERRIDE;
+    bool isOpen() Q_DECL_OVERRIDE { return true; }
+
+    // Request a dump of the ring. The dump is written by the logging thread of
+    // the UMApplicationMonitor, which is woken up if it's idle. Must be called
+    // from the GUI thread.
+    void requestDump();
+
+    // Automatically request a dump when the GUI, sync, render and swap times of a
+    // frame exceed threshold milliseconds. Jank triggered dumps are spaced by
+    // at least the duration covered by a dump. -1 to disable (default).
+    void setJankThreshold(int threshold);
+    int jankThreshold();
+
+    // Get the number of dumps written.
+    int dumpCount();
+
+private:
+    UMFlightRecorderPrivate* const d_ptr;
+    Q_DECLARE_PRIVATE(UMFlightRecorder)
+};
+
+// Aggregate frame events in per-window histograms and log summaries instead
+// of the frame events. Summaries are logged to the given logger every interval
+// milliseconds as generic events with the id returned by eventId() and a
+// string formatted as "FS <window> <metric> <count> <p50> <p90> <p99> <max>",
+// times are in microseconds and metric is one of delta, polish, gui, sync,
+// render, gpu or swap. Other events are forwarded untouched. The given logger
+// is owned.
+class UBUNTU_METRICS_EXPORT UMFrameSummaryLogger : public UMLogger
+{
+public:
+    UMFrameSummaryLogger(UMLogger* logger, int interval = 1000);
+    ~UMFrameSummaryLogger();
+
+    void log(const UMEvent& event) Q_DECL_OVERRIDE;
+    void logBatch(const UMEvent* events, int count) Q_DECL_OVERRIDE;
+    void flush() Q_DECL_OVERRIDE;
+    bool isOpen() Q_DECL_OVERRIDE;
+
+    // Get the generic event id of the summaries, registered at construction
+    // like the ids returned by UMApplicationMonitor::registerGenericEvent().
+    quint32 eventId();
+
+private:
+    UMFrameSummaryLoggerPrivate* const d_ptr;
+    Q_DECLARE_PRIVATE(UMFrameSummaryLogger)
+};
+
 #if defined(Q_OS_LINUX)
 
 // Log events to LTTng.
@@ -66,6 +157,7 @@ class UBUNTU_METRICS_EXPORT UMLTTNGLogger : public UMLogger
 public:
     UMLTTNGLogger();
     void log(const UMEvent& event) Q_DECL_OVERRIDE;
+    void logBatch(const UMEvent* events, int count) Q_DECL_OVERRIDE;
     bool isOpen() Q_DECL_OVERRIDE { return true; }
 
 private:
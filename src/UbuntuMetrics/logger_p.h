@@ -22,27 +22,122 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QTextStream>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QVector>
 
 #include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/private/histogram_p.h>
 #include <UbuntuMetrics/private/ubuntumetricsglobal_p.h>
 
+// Header of the binary trace files written by UMFileLogger. The header is
+// followed by a list of raw UMEvents stored in the byte order of the host.
+struct UBUNTU_METRICS_PRIVATE_EXPORT UMBinaryTraceHeader
+{
+    // Format versions:
+    // 1: initial format.
+    // 2: PSS, swap, context switches and page faults in UMProcessEvent.
+    // 3: UMThreadEvent.
+    // 4: polishTime and guiTime in UMFrameEvent.
+    // 5: 64-bit userTime and systemTime in UMThreadEvent.
+    static const quint32 currentVersion = 5;
+    static const quint32 byteOrderMark = 0x01020304;
+
+    // "UMTRACE" followed by a null-terminating char.
+    char magic[8];
+
+    // Version of the format, incremented when the UMEvent layout changes.
+    quint32 version;
+
+    // Size of an event in bytes (sizeof(UMEvent)).
+    quint32 eventSize;
+
+    // byteOrderMark written in the byte order of the host.
+    quint32 byteOrder;
+
+    // The whole struct must take 64 bytes.
+    quint8 __reserved[/*20 bytes taken,*/ 44 /*bytes free*/];
+};
+Q_STATIC_ASSERT(sizeof(UMBinaryTraceHeader) == 64);
+
 class UBUNTU_METRICS_PRIVATE_EXPORT UMFileLoggerPrivate
 {
 public:
     enum {
         Open     = (1 << 0),
         Colored  = (1 << 1),
-        Parsable = (1 << 2)
+        Parsable = (1 << 2),
+        Binary   = (1 << 3)
     };
 
-    UMFileLoggerPrivate(const QString& fileName, bool parsable);
+    // Number of events buffered before writing in binary mode.
+    static const int binaryBufferSize = 64;
+    // Max time in nanoseconds between two writes in binary mode.
+    static const quint64 binaryFlushInterval = 1000000000;
+
+    UMFileLoggerPrivate(const QString& fileName, UMFileLogger::Format format);
     UMFileLoggerPrivate(FILE* fileHandle, bool parsable);
+    ~UMFileLoggerPrivate();
 
     void log(const UMEvent& event);
+    void logBatch(const UMEvent* events, int count);
+    void logText(const UMEvent& event);
+    void logBinary(const UMEvent* events, int count);
+    void writeBinary(const UMEvent* events, int count);
 
     QFile m_file;
     QTextStream m_textStream;
+    UMEvent* m_binaryBuffer;
+    quint64 m_binaryFlushTimeStamp;
+    int m_binaryBufferCount;
     quint8 m_flags;
 };
 
+class UBUNTU_METRICS_PRIVATE_EXPORT UMFlightRecorderPrivate
+{
+public:
+    UMFlightRecorderPrivate(const QString& fileName, int duration, int maxEventCount);
+    ~UMFlightRecorderPrivate();
+
+    void log(const UMEvent* events, int count);
+    void dumpIfRequested();
+    void dump();
+
+    QString m_fileName;
+    UMEvent* m_ring;
+    quint64 m_duration;
+    quint64 m_lastDumpTimeStamp;
+    QAtomicInteger<int> m_jankThreshold;
+    QAtomicInteger<int> m_dumpRequested;
+    QAtomicInteger<int> m_dumpCount;
+    int m_ringSize;
+    int m_ringIndex;
+    int m_ringCount;
+};
+
+class UBUNTU_METRICS_PRIVATE_EXPORT UMFrameSummaryLoggerPrivate
+{
+public:
+    enum {
+        DeltaTime = 0, PolishTime, GuiTime, SyncTime, RenderTime, GpuTime, SwapTime, MetricCount
+    };
+
+    struct WindowHistograms {
+        quint32 window;
+        Histogram histograms[MetricCount];
+    };
+
+    UMFrameSummaryLoggerPrivate(UMLogger* logger, int interval);
+    ~UMFrameSummaryLoggerPrivate();
+
+    void log(const UMEvent* events, int count);
+    void recordFrame(const UMEvent& event);
+    void logSummaries(quint64 timeStamp);
+
+    UMLogger* m_logger;
+    QVector<WindowHistograms*> m_windows;
+    quint64 m_interval;
+    quint64 m_summaryTimeStamp;
+    quint32 m_eventId;
+};
+
 #endif  // LOGGER_P_H
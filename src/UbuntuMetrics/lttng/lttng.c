@@ -38,9 +38,15 @@ static void logGenericEvent(UMLTTNGGenericEvent* event)
     tracepoint(UbuntuMetrics, generic, event);
 }
 
+static void logThreadEvent(UMLTTNGThreadEvent* event)
+{
+    tracepoint(UbuntuMetrics, thread, event);
+}
+
 const struct UMLTTNGPlugin umLttngPlugin = {
     &logProcessEvent,
     &logFrameEvent,
     &logWindowEvent,
     &logGenericEvent,
+    &logThreadEvent,
 };
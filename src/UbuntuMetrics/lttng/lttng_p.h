@@ -25,12 +25,14 @@ typedef struct _UMLTTNGProcessEvent UMLTTNGProcessEvent;
 typedef struct _UMLTTNGFrameEvent UMLTTNGFrameEvent;
 typedef struct _UMLTTNGWindowEvent UMLTTNGWindowEvent;
 typedef struct _UMLTTNGGenericEvent UMLTTNGGenericEvent;
+typedef struct _UMLTTNGThreadEvent UMLTTNGThreadEvent;
 
 struct UMLTTNGPlugin {
     void (*logProcessEvent)(UMLTTNGProcessEvent*);
     void (*logFrameEvent)(UMLTTNGFrameEvent*);
     void (*logWindowEvent)(UMLTTNGWindowEvent*);
     void (*logGenericEvent)(UMLTTNGGenericEvent*);
+    void (*logThreadEvent)(UMLTTNGThreadEvent*);
 };
 
 struct _UMLTTNGProcessEvent {
@@ -38,6 +40,12 @@ struct _UMLTTNGProcessEvent {
     uint32_t rssMemory;
     uint16_t cpuUsage;
     uint16_t threadCount;
+    uint32_t pssMemory;
+    uint32_t swapMemory;
+    uint32_t voluntaryContextSwitches;
+    uint32_t involuntaryContextSwitches;
+    uint32_t minorPageFaults;
+    uint32_t majorPageFaults;
 };
 
 struct _UMLTTNGFrameEvent {
@@ -48,6 +56,8 @@ struct _UMLTTNGFrameEvent {
     float renderTime;
     float gpuTime;
     float swapTime;
+    float polishTime;
+    float guiTime;
 };
 
 struct _UMLTTNGWindowEvent {
@@ -65,4 +75,14 @@ struct _UMLTTNGGenericEvent {
     char string[64];
 };
 
+struct _UMLTTNGThreadEvent {
+    const char* role;
+    uint32_t id;
+    uint64_t userTime;
+    uint64_t systemTime;
+    uint16_t cpuUsage;
+    // Keep the size in sync with UMThreadEvent::maxNameSize.
+    char name[16];
+};
+
 #endif  // LTTNG_P_H
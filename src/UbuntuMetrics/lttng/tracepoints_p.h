@@ -36,6 +36,14 @@ TRACEPOINT_EVENT(
         ctf_integer(uint32_t, vsz_memory, processEvent->vszMemory)
         ctf_integer(uint32_t, rss_memory, processEvent->rssMemory)
         ctf_integer(uint16_t, thread_count, processEvent->threadCount)
+        ctf_integer(uint32_t, pss_memory, processEvent->pssMemory)
+        ctf_integer(uint32_t, swap_memory, processEvent->swapMemory)
+        ctf_integer(uint32_t, voluntary_context_switches,
+                    processEvent->voluntaryContextSwitches)
+        ctf_integer(uint32_t, involuntary_context_switches,
+                    processEvent->involuntaryContextSwitches)
+        ctf_integer(uint32_t, minor_page_faults, processEvent->minorPageFaults)
+        ctf_integer(uint32_t, major_page_faults, processEvent->majorPageFaults)
     )
 )
 
@@ -52,6 +60,8 @@ TRACEPOINT_EVENT(
         ctf_float(float, render_time, frameEvent->renderTime)
         ctf_float(float, gpu_time, frameEvent->gpuTime)
         ctf_float(float, swap_time, frameEvent->swapTime)
+        ctf_float(float, polish_time, frameEvent->polishTime)
+        ctf_float(float, gui_time, frameEvent->guiTime)
     )
 )
 
@@ -79,5 +89,20 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    UbuntuMetrics, thread,
+    TP_ARGS(
+        UMLTTNGThreadEvent*, threadEvent
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, id, threadEvent->id)
+        ctf_string(role, threadEvent->role)
+        ctf_string(name, threadEvent->name)
+        ctf_integer(uint16_t, cpu_usage, threadEvent->cpuUsage)
+        ctf_integer(uint64_t, user_time, threadEvent->userTime)
+        ctf_integer(uint64_t, system_time, threadEvent->systemTime)
+    )
+)
+
 #endif  // TRACEPOINTS_P_H
 #include <lttng/tracepoint-event.h>
@@ -55,18 +55,23 @@ static const struct {
     { "threadCount", sizeof("threadCount") - 1, 3, UMEvent::Process },
     { "vszMemory",   sizeof("vszMemory") - 1,   8, UMEvent::Process },
     { "rssMemory",   sizeof("rssMemory") - 1,   8, UMEvent::Process },
+    { "pssMemory",   sizeof("pssMemory") - 1,   8, UMEvent::Process },
+    { "swapMemory",  sizeof("swapMemory") - 1,  8, UMEvent::Process },
     { "windowId",    sizeof("windowId") - 1,    2, UMEvent::Window  },
     { "windowSize",  sizeof("windowSize") - 1,  9, UMEvent::Window  },
     { "frameNumber", sizeof("frameNumber") - 1, 7, UMEvent::Frame   },
     { "deltaTime",   sizeof("deltaTime") - 1,   7, UMEvent::Frame   },
+    { "polishTime",  sizeof("polishTime") - 1,  7, UMEvent::Frame   },
+    { "guiTime",     sizeof("guiTime") - 1,     7, UMEvent::Frame   },
     { "syncTime",    sizeof("syncTime") - 1,    7, UMEvent::Frame   },
     { "renderTime",  sizeof("renderTime") - 1,  7, UMEvent::Frame   },
     { "gpuTime",     sizeof("gpuTime") - 1,     7, UMEvent::Frame   },
     { "totalTime",   sizeof("totalTime") - 1,   7, UMEvent::Frame   }
 };
 enum {
-    CpuUsage = 0, ThreadCount, VszMemory, RssMemory, WindowId, WindowSize, FrameNumber, DeltaTime,
-    SyncTime, RenderTime, GpuTime, TotalTime, MetricCount
+    CpuUsage = 0, ThreadCount, VszMemory, RssMemory, PssMemory, SwapMemory, WindowId, WindowSize,
+    FrameNumber, DeltaTime, PolishTime, GuiTime, SyncTime, RenderTime, GpuTime, TotalTime,
+    MetricCount
 };
 Q_STATIC_ASSERT(ARRAY_SIZE(metricInfo) == MetricCount);
 
@@ -251,6 +256,12 @@ void Overlay::updateFrameMetrics(const UMEvent& event)
         case DeltaTime:
             timeMetricToText(event.frame.deltaTime, text, textWidth);
             break;
+        case PolishTime:
+            timeMetricToText(event.frame.polishTime, text, textWidth);
+            break;
+        case GuiTime:
+            timeMetricToText(event.frame.guiTime, text, textWidth);
+            break;
         case SyncTime:
             timeMetricToText(event.frame.syncTime, text, textWidth);
             break;
@@ -343,6 +354,12 @@ void Overlay::updateProcessMetrics()
         case RssMemory:
             integerMetricToText(m_processEvent.process.rssMemory, text, textWidth);
             break;
+        case PssMemory:
+            integerMetricToText(m_processEvent.process.pssMemory, text, textWidth);
+            break;
+        case SwapMemory:
+            integerMetricToText(m_processEvent.process.swapMemory, text, textWidth);
+            break;
         default:
             DNOT_REACHED();
             break;
@@ -0,0 +1,214 @@
+// Copyright © 2016 Canonical Ltd.
+// Author: Loïc Molinari <loic.molinari@canonical.com>
+//
+// This file is part of Ubuntu UI Toolkit.
+//
+// Ubuntu UI Toolkit is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation; version 3.
+//
+// Ubuntu UI Toolkit is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Ubuntu UI Toolkit. If not, see <http://www.gnu.org/licenses/>.
+
+// Decodes the binary traces written by UMFileLogger in Binary format. Events
+// are converted to the text formats of UMFileLogger or to CSV, for instance:
+// $ ./umtracedecoder -f csv trace.umt > trace.csv
+
+#include <cstdio>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+
+#include <UbuntuMetrics/logger.h>
+#include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/private/logger_p.h>
+
+// Number of events read at once.
+const int readBufferSize = 256;
+
+static bool checkHeader(const UMBinaryTraceHeader& header)
+{
+    if (memcmp(header.magic, "UMTRACE", sizeof(header.magic))) {
+        qWarning("Not an UbuntuMetrics binary trace.");
+        return false;
+    }
+    if (header.byteOrder != UMBinaryTraceHeader::byteOrderMark) {
+        qWarning("Trace written with a different byte order, not supported.");
+        return false;
+    }
+    if (header.version != UMBinaryTraceHeader::currentVersion
+        || header.eventSize != sizeof(UMEvent)) {
+        qWarning("Unsupported trace version %u (event size %u), expected version %u.",
+                 header.version, header.eventSize, UMBinaryTraceHeader::currentVersion);
+        return false;
+    }
+    return true;
+}
+
+static void writeCsvHeader(QTextStream& out)
+{
+    out << "type,timeStamp,id,state,width,height,number,deltaTime,syncTime,renderTime,"
+        << "gpuTime,swapTime,polishTime,guiTime,cpuUsage,vszMemory,rssMemory,threadCount,"
+        << "pssMemory,swapMemory,voluntaryContextSwitches,involuntaryContextSwitches,"
+        << "minorPageFaults,majorPageFaults,role,userTime,systemTime,string\n";
+}
+
+static void writeCsvEvent(QTextStream& out, const UMEvent& event)
+{
+    switch (event.type) {
+    case UMEvent::Process:
+        out << "P," << event.timeStamp << ",,,,,,,,,,,,,"
+            << event.process.cpuUsage << ','
+            << event.process.vszMemory << ','
+            << event.process.rssMemory << ','
+            << event.process.threadCount << ','
+            << event.process.pssMemory << ','
+            << event.process.swapMemory << ','
+            << event.process.voluntaryContextSwitches << ','
+            << event.process.involuntaryContextSwitches << ','
+            << event.process.minorPageFaults << ','
+            << event.process.majorPageFaults << ",,,,\n";
+        break;
+
+    case UMEvent::Window:
+        out << "W," << event.timeStamp << ','
+            << event.window.id << ','
+            << event.window.state << ','
+            << event.window.width << ','
+            << event.window.height << ",,,,,,,,,,,,,,,,,,,,,,\n";
+        break;
+
+    case UMEvent::Frame:
+        out << "F," << event.timeStamp << ','
+            << event.frame.window << ",,,,"
+            << event.frame.number << ','
+            << event.frame.deltaTime << ','
+            << event.frame.syncTime << ','
+            << event.frame.renderTime << ','
+            << event.frame.gpuTime << ','
+            << event.frame.swapTime << ','
+            << event.frame.polishTime << ','
+            << event.frame.guiTime << ",,,,,,,,,,,,,,\n";
+        break;
+
+    case UMEvent::Generic: {
+        // Quotes are escaped by doubling them.
+        const QString string = QString::fromLatin1(
+            event.generic.string, qstrnlen(event.generic.string, event.generic.stringSize));
+        out << "G," << event.timeStamp << ','
+            << event.generic.id << ",,,,,,,,,,,,,,,,,,,,,,,,,\""
+            << QString(string).replace(QLatin1Char('"'), QStringLiteral("\"\"")) << "\"\n";
+        break;
+    }
+
+    case UMEvent::Thread:
+        out << "T," << event.timeStamp << ','
+            << event.thread.id << ",,,,,,,,,,,,"
+            << event.thread.cpuUsage << ",,,,,,,,,,"
+            << event.thread.role << ','
+            << event.thread.userTime << ','
+            << event.thread.systemTime << ",\""
+            << event.thread.name << "\"\n";
+        break;
+
+    default:
+        break;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser args;
+    QCommandLineOption formatOption(
+        QStringList() << "f" << "format", "Output format, <format> can be 'parsable' "
+        "(default), 'text' or 'csv'.", "format", "parsable");
+    QCommandLineOption outputOption(
+        QStringList() << "o" << "output", "Write to <file> instead of the standard output.",
+        "file");
+    args.addOption(formatOption);
+    args.addOption(outputOption);
+    args.addHelpOption();
+    args.addPositionalArgument("trace", "Binary trace written by UMFileLogger.");
+    args.process(application);
+
+    if (args.positionalArguments().size() != 1) {
+        args.showHelp(1);
+    }
+    const QString format = args.value(formatOption);
+    if (format != "parsable" && format != "text" && format != "csv") {
+        qWarning("Unknown format '%s'.", qPrintable(format));
+        return 1;
+    }
+
+    QFile input(args.positionalArguments().first());
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning("Can't open trace '%s': %s.", qPrintable(input.fileName()),
+                 qPrintable(input.errorString()));
+        return 1;
+    }
+    UMBinaryTraceHeader header;
+    if (input.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+        || !checkHeader(header)) {
+        return 1;
+    }
+
+    // The text formats are generated by a UMFileLogger so that the output is
+    // the same as the one logged at run-time.
+    FILE* outputHandle = stdout;
+    if (args.isSet(outputOption)) {
+        outputHandle = fopen(qPrintable(args.value(outputOption)), "w");
+        if (!outputHandle) {
+            qWarning("Can't create file '%s'.", qPrintable(args.value(outputOption)));
+            return 1;
+        }
+    }
+    UMFileLogger* logger = nullptr;
+    QFile csvFile;
+    QTextStream csvStream;
+    if (format == "csv") {
+        csvFile.open(outputHandle, QIODevice::WriteOnly | QIODevice::Text);
+        csvStream.setDevice(&csvFile);
+        writeCsvHeader(csvStream);
+    } else {
+        logger = new UMFileLogger(outputHandle, format == "parsable");
+    }
+
+    UMEvent events[readBufferSize];
+    qint64 size;
+    while ((size = input.read(reinterpret_cast<char*>(events), sizeof(events))) > 0) {
+        const int count = size / sizeof(UMEvent);
+        for (int i = 0; i < count; ++i) {
+            if (events[i].type >= UMEvent::TypeCount) {
+                qWarning("Skipping invalid event with type %d.", events[i].type);
+                continue;
+            }
+            if (logger) {
+                logger->log(events[i]);
+            } else {
+                writeCsvEvent(csvStream, events[i]);
+            }
+        }
+        if (size % sizeof(UMEvent)) {
+            qWarning("Truncated trace, last event ignored.");
+            break;
+        }
+    }
+
+    delete logger;
+    csvStream.flush();
+    csvFile.close();
+    if (outputHandle != stdout) {
+        fclose(outputHandle);
+    }
+
+    return 0;
+}
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = umtracedecoder
+QT = core UbuntuMetrics UbuntuMetrics-private
+CONFIG += c++11
+SOURCES += tracedecoder.cpp
+target.path = $$[QT_INSTALL_PREFIX]/bin
+INSTALLS += target
@@ -13,6 +13,9 @@ unix {
     SOURCES += mousetouchadaptor_x11.cpp
 }
 
+# Keys the on-disk caches on the toolkit version.
+DEFINES += UBUNTUTOOLKIT_VERSION_STRING=\\\"$$MODULE_VERSION\\\"
+
 # Uncomment to compile out qDebug() calls.
 # DEFINES += QT_NO_DEBUG_OUTPUT
 
@@ -47,6 +50,7 @@ HEADERS += \
     $$PWD/privates/listitemdraghandler_p.h \
     $$PWD/privates/listitemselection_p.h \
     $$PWD/privates/listviewextensions_p.h \
+    $$PWD/privates/programbinarycache_p.h \
     $$PWD/privates/splitviewhandler_p.h \
     $$PWD/privates/threelabelsslot_p.h \
     $$PWD/privates/ucpagewrapper_p.h \
@@ -80,6 +84,7 @@ HEADERS += \
     $$PWD/ucapplication_p.h \
     $$PWD/ucargument_p.h \
     $$PWD/ucarguments_p.h \
+    $$PWD/ucasyncimageprovider_p.h \
     $$PWD/ucbottomedge_p.h \
     $$PWD/ucbottomedge_p_p.h \
     $$PWD/ucbottomedgehint_p.h \
@@ -158,6 +163,7 @@ SOURCES += \
     $$PWD/privates/listitemexpansion.cpp \
     $$PWD/privates/listitemselection.cpp \
     $$PWD/privates/listviewextensions.cpp \
+    $$PWD/privates/programbinarycache.cpp \
     $$PWD/privates/splitviewhandler.cpp \
     $$PWD/privates/threelabelsslot_p.cpp \
     $$PWD/privates/ucpagewrapper.cpp \
@@ -184,6 +190,7 @@ SOURCES += \
     $$PWD/ucapplication.cpp \
     $$PWD/ucargument.cpp \
     $$PWD/ucarguments.cpp \
+    $$PWD/ucasyncimageprovider.cpp \
     $$PWD/ucbottomedge.cpp \
     $$PWD/ucbottomedgehint.cpp \
     $$PWD/ucbottomedgeregion.cpp \
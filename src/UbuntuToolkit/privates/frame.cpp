@@ -18,9 +18,11 @@
 
 #include "privates/frame_p.h"
 
+#include <QtCore/QDebug>
 #include <QtGui/QOpenGLContext>
 #include <QtGui/QOpenGLFunctions>
 
+#include "privates/programbinarycache_p.h"
 #include "privates/textures_p.h"
 
 UT_NAMESPACE_BEGIN
@@ -40,6 +42,11 @@ public:
     void updateState(
         const RenderState& state, QSGMaterial* newEffect, QSGMaterial* oldEffect) override;
 
+protected:
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+    void compile() override;
+#endif
+
 private:
     int m_matrixId;
     int m_opacityId;
@@ -61,6 +68,16 @@ char const* const* FrameShader::attributeNames() const
     return attributes;
 }
 
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+void FrameShader::compile()
+{
+    if (!ProgramBinaryCache::link(program(), vertexShader(), fragmentShader(), attributeNames())) {
+        qWarning("FrameShader: Shader compilation failed:");
+        qWarning() << program()->log();
+    }
+}
+#endif
+
 void FrameShader::initialize()
 {
     QSGMaterialShader::initialize();
@@ -180,11 +197,14 @@ UCFrameNode::UCFrameNode()
     : QSGGeometryNode()
     , m_material()
     , m_geometry(attributeSet(), 20, 34, GL_UNSIGNED_SHORT)
+    , m_thickness(0.0f)
+    , m_radius(0.0f)
+    , m_color(0)
 {
     memcpy(m_geometry.indexData(), indices(), 34 * sizeof(unsigned short));
     m_geometry.setDrawingMode(GL_TRIANGLE_STRIP);
     m_geometry.setIndexDataPattern(QSGGeometry::StaticPattern);
-    m_geometry.setVertexDataPattern(QSGGeometry::AlwaysUploadPattern);
+    m_geometry.setVertexDataPattern(QSGGeometry::StaticPattern);
     setMaterial(&m_material);
     setGeometry(&m_geometry);
     qsgnode_set_description(this, QLatin1String("frame"));
@@ -243,6 +263,16 @@ static quint32 packColor(QRgb color)
 void UCFrameNode::updateGeometry(
     const QSizeF& itemSize, float thickness, float radius, QRgb color)
 {
+    // The vertices are uploaded once and only rebuilt when the properties they depend on change.
+    // The size is null at construction time and empty sizes are never passed.
+    if (itemSize == m_size && thickness == m_thickness && radius == m_radius && color == m_color) {
+        return;
+    }
+    m_size = itemSize;
+    m_thickness = thickness;
+    m_radius = radius;
+    m_color = color;
+
     UCFrameNode::Vertex* v = reinterpret_cast<UCFrameNode::Vertex*>(m_geometry.vertexData());
     const float w = static_cast<float>(itemSize.width());
     const float h = static_cast<float>(itemSize.height());
@@ -412,6 +442,7 @@ void UCFrameNode::updateGeometry(
     v[19].t2 = innerCoord1;
     v[19].color = packedColor;
 
+    m_geometry.markVertexDataDirty();
     markDirty(QSGNode::DirtyGeometry);
 }
 
@@ -55,6 +55,10 @@ public:
 private:
     UCFrameMaterial m_material;
     QSGGeometry m_geometry;
+    QSizeF m_size;
+    float m_thickness;
+    float m_radius;
+    QRgb m_color;
 };
 
 // Renders the frame (border) of a shape.
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "privates/programbinarycache_p.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+UT_NAMESPACE_BEGIN
+
+typedef void (QOPENGLF_APIENTRYP GetProgramBinaryFunc)(
+    GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (QOPENGLF_APIENTRYP ProgramBinaryFunc)(
+    GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+struct BinaryFunctions
+{
+    GetProgramBinaryFunc getProgramBinary;
+    ProgramBinaryFunc programBinary;
+};
+
+// Header of the cache files, followed by the program binary.
+struct BinaryHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 format;
+    quint32 size;
+};
+
+const quint32 binaryMagic = 0x42504355;  // "UCPB" in little endian.
+const quint32 binaryVersion = 1;
+
+// Links can happen concurrently on the render threads of different windows.
+static QAtomicInt hits;
+static QAtomicInt misses;
+
+static bool cacheEnabled()
+{
+    static const bool enabled = !qEnvironmentVariableIsSet("UC_DISABLE_PROGRAM_BINARY_CACHE");
+    return enabled;
+}
+
+static QString cachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QStringLiteral("/ubuntu-ui-toolkit/programs");
+}
+
+// Resolves the program binary entry points of the current context. Returns false if program
+// binaries aren't supported.
+static bool resolveFunctions(QOpenGLContext* context, BinaryFunctions* functions)
+{
+    const QSurfaceFormat format = context->format();
+    const int version = (format.majorVersion() << 8) | format.minorVersion();
+    bool oes = false;
+    if (context->isOpenGLES()) {
+        if (version < 0x300) {
+            if (!context->hasExtension(QByteArrayLiteral("GL_OES_get_program_binary"))) {
+                return false;
+            }
+            oes = true;
+        }
+    } else if (version < 0x401
+               && !context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary"))) {
+        return false;
+    }
+
+    // Some drivers expose the entry points without supporting any binary format.
+    GLint formatCount = 0;
+    context->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) {
+        return false;
+    }
+
+    functions->getProgramBinary = reinterpret_cast<GetProgramBinaryFunc>(
+        context->getProcAddress(oes ? "glGetProgramBinaryOES" : "glGetProgramBinary"));
+    functions->programBinary = reinterpret_cast<ProgramBinaryFunc>(
+        context->getProcAddress(oes ? "glProgramBinaryOES" : "glProgramBinary"));
+    return functions->getProgramBinary && functions->programBinary;
+}
+
+static QString cacheFileName(
+    QOpenGLFunctions* funcs, const char* vertexSource, const char* fragmentSource,
+    char const* const* attributeNames)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(reinterpret_cast<const char*>(funcs->glGetString(GL_VENDOR)));
+    hash.addData(reinterpret_cast<const char*>(funcs->glGetString(GL_RENDERER)));
+    hash.addData(reinterpret_cast<const char*>(funcs->glGetString(GL_VERSION)));
+    hash.addData(vertexSource);
+    hash.addData(fragmentSource);
+    for (int i = 0; attributeNames[i]; i++) {
+        hash.addData(QByteArray::number(i));
+        hash.addData(attributeNames[i]);
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+static bool loadBinary(
+    QOpenGLShaderProgram* program, QOpenGLFunctions* funcs, const BinaryFunctions& functions,
+    const QString& fileName)
+{
+    QFile file(cachePath() + QLatin1Char('/') + fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    BinaryHeader header;
+    if (data.size() <= static_cast<int>(sizeof(BinaryHeader))) {
+        file.remove();
+        return false;
+    }
+    memcpy(&header, data.constData(), sizeof(BinaryHeader));
+    if (header.magic != binaryMagic || header.version != binaryVersion
+        || header.size != data.size() - sizeof(BinaryHeader)) {
+        file.remove();
+        return false;
+    }
+
+    if (!program->create()) {
+        return false;
+    }
+    const GLuint id = program->programId();
+    functions.programBinary(
+        id, header.format, data.constData() + sizeof(BinaryHeader), header.size);
+
+    // Drivers are allowed to reject binaries at any time (after a driver update not reflected in
+    // the version string for instance), the entry is then dropped and the sources are compiled.
+    GLint status = 0;
+    funcs->glGetProgramiv(id, GL_LINK_STATUS, &status);
+    if (!status) {
+        file.remove();
+        return false;
+    }
+
+    // No shaders being attached, QOpenGLShaderProgram::link() only checks the link status.
+    return program->link();
+}
+
+static void saveBinary(
+    QOpenGLShaderProgram* program, QOpenGLFunctions* funcs, const BinaryFunctions& functions,
+    const QString& fileName)
+{
+    const GLuint id = program->programId();
+    GLint length = 0;
+    funcs->glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    QByteArray data(sizeof(BinaryHeader) + length, Qt::Uninitialized);
+    GLsizei written = 0;
+    GLenum format = 0;
+    functions.getProgramBinary(
+        id, length, &written, &format, data.data() + sizeof(BinaryHeader));
+    if (written <= 0) {
+        return;
+    }
+    const BinaryHeader header = {
+        binaryMagic, binaryVersion, static_cast<quint32>(format), static_cast<quint32>(written)
+    };
+    memcpy(data.data(), &header, sizeof(BinaryHeader));
+    data.resize(sizeof(BinaryHeader) + written);
+
+    const QString path = cachePath();
+    if (!QDir().mkpath(path)) {
+        return;
+    }
+    QSaveFile file(path + QLatin1Char('/') + fileName);
+    if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size()) {
+        file.commit();
+    }
+}
+
+bool ProgramBinaryCache::link(
+    QOpenGLShaderProgram* program, const char* vertexSource, const char* fragmentSource,
+    char const* const* attributeNames)
+{
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    Q_ASSERT(context);
+    QOpenGLFunctions* funcs = context->functions();
+    BinaryFunctions functions;
+    const bool useCache = cacheEnabled() && resolveFunctions(context, &functions);
+    QString fileName;
+
+    if (useCache) {
+        fileName = cacheFileName(funcs, vertexSource, fragmentSource, attributeNames);
+        if (loadBinary(program, funcs, functions, fileName)) {
+            hits.ref();
+            return true;
+        }
+        misses.ref();
+    }
+
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource);
+    for (int i = 0; attributeNames[i]; i++) {
+        if (*attributeNames[i]) {
+            program->bindAttributeLocation(attributeNames[i], i);
+        }
+    }
+    if (!program->link()) {
+        return false;
+    }
+
+    if (useCache) {
+        saveBinary(program, funcs, functions, fileName);
+    }
+    return true;
+}
+
+int ProgramBinaryCache::hitCount()
+{
+    return hits.load();
+}
+
+int ProgramBinaryCache::missCount()
+{
+    return misses.load();
+}
+
+UT_NAMESPACE_END
+
+#endif  // QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
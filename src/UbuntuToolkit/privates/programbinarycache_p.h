@@ -0,0 +1,57 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROGRAMBINARYCACHE_P_H
+#define PROGRAMBINARYCACHE_P_H
+
+#include <UbuntuToolkit/ubuntutoolkitglobal.h>
+
+// Since Qt 5.9, QtQuick caches the program binaries of all the material shaders itself, including
+// the ones it rewrites for merged batches that never go through QSGMaterialShader::compile().
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+
+class QOpenGLShaderProgram;
+
+UT_NAMESPACE_BEGIN
+
+// Links shader programs using binaries stored in the user cache dir when the OpenGL implementation
+// supports program binaries (GL_OES_get_program_binary, GL_ARB_get_program_binary or OpenGL ES 3),
+// compiles and links the sources otherwise. Entries are keyed on the sources, the attribute
+// bindings and the GL_VENDOR, GL_RENDERER and GL_VERSION strings so that driver updates
+// invalidate them. Setting UC_DISABLE_PROGRAM_BINARY_CACHE in the environment disables the cache.
+//
+// The batch renderer only calls QSGMaterialShader::compile() for unmerged batches, so only the
+// programs of these go through the cache. hitCount() and missCount() tell how many links were
+// served by the cache and how many had to compile the sources while the cache was usable.
+class UBUNTUTOOLKIT_EXPORT ProgramBinaryCache
+{
+public:
+    // Links program from the given null-terminated sources and attribute names (bound to their
+    // index, empty names being skipped). An OpenGL context must be current. Returns true if the
+    // program is linked.
+    static bool link(
+        QOpenGLShaderProgram* program, const char* vertexSource, const char* fragmentSource,
+        char const* const* attributeNames);
+
+    static int hitCount();
+    static int missCount();
+};
+
+UT_NAMESPACE_END
+
+#endif  // QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+
+#endif  // PROGRAMBINARYCACHE_P_H
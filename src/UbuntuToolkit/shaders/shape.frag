@@ -16,28 +16,32 @@
 //
 // Author: Loïc Molinari <loic.molinari@canonical.com>
 
-// Static flow control (branching on a uniform value) is fast on most GPUs (including ultra-low
-// power ones) because it allows to use the same shader execution path for an entire draw call. We
+// Branching on the aspect, which is constant for all the fragments of a shape, is fast on most GPUs
+// (including ultra-low power ones) because neighbouring fragments take the same execution path. We
 // rely on that technique here (also known as "uber-shader" solution) to avoid the complexity of
-// dealing with a multiple shaders solution.
-// FIXME(loicm) Validate GPU behavior with regards to static flow control.
+// dealing with a multiple shaders solution. Storing the aspect and the other per-shape parameters
+// in the vertices (and not in uniforms) allows shapes with different parameters to be batched.
+// FIXME(loicm) Validate GPU behavior with regards to that kind of flow control.
 
 uniform sampler2D shapeTexture;
 uniform sampler2D sourceTexture;
-uniform lowp vec2 opacityFactors;
-uniform lowp float sourceOpacity;
+uniform lowp float opacity;
 uniform lowp float distanceAA;
 uniform bool textured;
-uniform mediump int aspect;
+uniform mediump vec2 sourceHalfTexel;
 
 varying mediump vec2 shapeCoord;
 varying mediump vec4 sourceCoord;
+varying mediump vec4 sourceRect;
 varying lowp float yCoord;
 varying lowp vec4 backgroundColor;
+varying lowp vec4 parameters;
 
-const mediump int FLAT        = 0x08;  // 1 << 3
-const mediump int INSET       = 0x10;  // 1 << 4
-const mediump int DROP_SHADOW = 0x20;  // 1 << 5
+// Aspects are packed in the w component of the per-shape parameters as 0 (none), 1/3 (flat), 2/3
+// (inset) and 1 (drop shadow), these are the thresholds in between.
+const lowp float FLAT        = 0.1667;
+const lowp float INSET       = 0.5;
+const lowp float DROP_SHADOW = 0.8333;
 
 void main(void)
 {
@@ -49,7 +53,20 @@ void main(void)
         // FIXME(loicm) sign() is far from optimal. Call texture2D() at beginning of scope.
         lowp vec2 axisMask = -sign((sourceCoord.zw * sourceCoord.zw) - vec2(1.0));
         lowp float mask = clamp(axisMask.x + axisMask.y, 0.0, 1.0);
-        lowp vec4 source = texture2D(sourceTexture, sourceCoord.st) * vec4(sourceOpacity * mask);
+        // The repeat wrap mode is emulated so that sources in a texture atlas don't have to be
+        // extracted. Source coordinates are normalized in the source area, the ones of repeated
+        // axes (flagged by a negative size) are wrapped, then they are all mapped to the texture
+        // sub-rectangle of the source. Wrapped coordinates are clamped half a texel inside the
+        // sub-rectangle so that linear filtering doesn't blend in neighbouring atlas texels at
+        // the seams. Mipmapped and non-atlas sources rely on GL_REPEAT instead.
+        lowp vec2 repeated = step(sourceRect.zw, vec2(0.0));
+        mediump vec2 coord = mix(sourceCoord.st, fract(sourceCoord.st), repeated);
+        mediump vec2 size = abs(sourceRect.zw);
+        mediump vec2 textureCoord = coord * size + sourceRect.xy;
+        mediump vec2 clamped = clamp(
+            textureCoord, sourceRect.xy + sourceHalfTexel, sourceRect.xy + size - sourceHalfTexel);
+        textureCoord = mix(textureCoord, clamped, repeated);
+        lowp vec4 source = texture2D(sourceTexture, textureCoord) * vec4(parameters.x * mask);
         color = vec4(1.0 - source.a) * color + source;
     }
 
@@ -57,15 +74,17 @@ void main(void)
     // texture coordinate. dFd*() functions have to be called outside of branches in order to work
     // correctly with VMware's "Gallium 0.4 on SVGA3D".
     lowp float dist = length(vec2(dFdx(shapeCoord.s), dFdy(shapeCoord.s)));
+    lowp float shapeDistanceAA = parameters.y * distanceAA;
 
-    if (aspect == FLAT) {
+    lowp float aspect = parameters.w;
+    if (aspect >= FLAT && aspect < INSET) {
         // Mask the current color with an anti-aliased and resolution independent shape mask built
         // from distance fields.
-        lowp float distanceMin = abs(dist) * -distanceAA + 0.5;
-        lowp float distanceMax = abs(dist) * distanceAA + 0.5;
+        lowp float distanceMin = abs(dist) * -shapeDistanceAA + 0.5;
+        lowp float distanceMax = abs(dist) * shapeDistanceAA + 0.5;
         color *= smoothstep(distanceMin, distanceMax, shapeData.b);
 
-    } else if (aspect == INSET) {
+    } else if (aspect >= INSET && aspect < DROP_SHADOW) {
         // The vertex layout of the shape is made so that the derivative is negative from top to
         // middle and positive from middle to bottom.
         lowp float shapeSide = yCoord <= 0.0 ? 0.0 : 1.0;
@@ -74,8 +93,8 @@ void main(void)
         lowp float shadow = shapeData[int(shapeSide)];
         color = vec4(1.0 - shadow) * color + vec4(0.0, 0.0, 0.0, shadow);
         // Get the anti-aliased and resolution independent shape mask using distance fields.
-        lowp float distanceMin = abs(dist) * -distanceAA + 0.5;
-        lowp float distanceMax = abs(dist) * distanceAA + 0.5;
+        lowp float distanceMin = abs(dist) * -shapeDistanceAA + 0.5;
+        lowp float distanceMax = abs(dist) * shapeDistanceAA + 0.5;
         lowp vec2 mask = smoothstep(distanceMin, distanceMax, shapeData.ba);
         // Get the bevel color. The bevel is made of the top mask masked with the bottom mask. A
         // gradient from the bottom (1) to the middle (0) of the shape is used to factor out values
@@ -87,10 +106,10 @@ void main(void)
         // additive blending since the bevel has already been masked.
         color = (color * vec4(mask[int(shapeSide)])) + vec4(bevel);
 
-    } else if (aspect == DROP_SHADOW) {
+    } else if (aspect >= DROP_SHADOW) {
         // Get the anti-aliased and resolution independent shape mask using distance fields.
-        lowp float distanceMin = abs(dist) * -distanceAA + 0.5;
-        lowp float distanceMax = abs(dist) * distanceAA + 0.5;
+        lowp float distanceMin = abs(dist) * -shapeDistanceAA + 0.5;
+        lowp float distanceMax = abs(dist) * shapeDistanceAA + 0.5;
         lowp int shapeSide = yCoord <= 0.0 ? 0 : 1;
         lowp float mask = smoothstep(distanceMin, distanceMax, shapeData[shapeSide]);
         // Get the shadow color outside of the shape mask.
@@ -100,5 +119,6 @@ void main(void)
         color = (color * vec4(mask)) + vec4(0.0, 0.0, 0.0, shadow);
     }
 
-    gl_FragColor = color * opacityFactors.xxxy;
+    // The pressed aspect is implemented by scaling the final RGB fragment color.
+    gl_FragColor = color * vec4(vec3(parameters.z * opacity), opacity);
 }
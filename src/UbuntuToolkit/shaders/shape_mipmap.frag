@@ -14,27 +14,31 @@
 //
 // Author: Loïc Molinari <loic.molinari@canonical.com>
 
-// Static flow control (branching on a uniform value) is fast on most GPUs (including ultra-low
-// power ones) because it allows to use the same shader execution path for an entire draw call. We
+// Branching on the aspect, which is constant for all the fragments of a shape, is fast on most GPUs
+// (including ultra-low power ones) because neighbouring fragments take the same execution path. We
 // rely on that technique here (also known as "uber-shader" solution) to avoid the complexity of
-// dealing with a multiple shaders solution.
-// FIXME(loicm) Validate GPU behavior with regards to static flow control.
+// dealing with a multiple shaders solution. Storing the aspect and the other per-shape parameters
+// in the vertices (and not in uniforms) allows shapes with different parameters to be batched.
+// FIXME(loicm) Validate GPU behavior with regards to that kind of flow control.
 
 uniform sampler2D shapeTexture;
 uniform sampler2D sourceTexture;
-uniform lowp vec2 opacityFactors;
-uniform lowp float sourceOpacity;
+uniform lowp float opacity;
 uniform bool textured;
-uniform mediump int aspect;
+uniform mediump vec2 sourceHalfTexel;
 
 varying mediump vec2 shapeCoord;
 varying mediump vec4 sourceCoord;
+varying mediump vec4 sourceRect;
 varying lowp float yCoord;
 varying lowp vec4 backgroundColor;
+varying lowp vec4 parameters;
 
-const mediump int FLAT        = 0x08;  // 1 << 3
-const mediump int INSET       = 0x10;  // 1 << 4
-const mediump int DROP_SHADOW = 0x20;  // 1 << 5
+// Aspects are packed in the w component of the per-shape parameters as 0 (none), 1/3 (flat), 2/3
+// (inset) and 1 (drop shadow), these are the thresholds in between.
+const lowp float FLAT        = 0.1667;
+const lowp float INSET       = 0.5;
+const lowp float DROP_SHADOW = 0.8333;
 
 void main(void)
 {
@@ -46,15 +50,29 @@ void main(void)
         // FIXME(loicm) sign() is far from optimal. Call texture2D() at beginning of scope.
         lowp vec2 axisMask = -sign((sourceCoord.zw * sourceCoord.zw) - vec2(1.0));
         lowp float mask = clamp(axisMask.x + axisMask.y, 0.0, 1.0);
-        lowp vec4 source = texture2D(sourceTexture, sourceCoord.st) * vec4(sourceOpacity * mask);
+        // The repeat wrap mode is emulated so that sources in a texture atlas don't have to be
+        // extracted. Source coordinates are normalized in the source area, the ones of repeated
+        // axes (flagged by a negative size) are wrapped, then they are all mapped to the texture
+        // sub-rectangle of the source. Wrapped coordinates are clamped half a texel inside the
+        // sub-rectangle so that linear filtering doesn't blend in neighbouring atlas texels at
+        // the seams. Mipmapped and non-atlas sources rely on GL_REPEAT instead.
+        lowp vec2 repeated = step(sourceRect.zw, vec2(0.0));
+        mediump vec2 coord = mix(sourceCoord.st, fract(sourceCoord.st), repeated);
+        mediump vec2 size = abs(sourceRect.zw);
+        mediump vec2 textureCoord = coord * size + sourceRect.xy;
+        mediump vec2 clamped = clamp(
+            textureCoord, sourceRect.xy + sourceHalfTexel, sourceRect.xy + size - sourceHalfTexel);
+        textureCoord = mix(textureCoord, clamped, repeated);
+        lowp vec4 source = texture2D(sourceTexture, textureCoord) * vec4(parameters.x * mask);
         color = vec4(1.0 - source.a) * color + source;
     }
 
-    if (aspect == FLAT) {
+    lowp float aspect = parameters.w;
+    if (aspect >= FLAT && aspect < INSET) {
         // Mask the current color.
       color *= shapeData.b;
 
-    } else if (aspect == INSET) {
+    } else if (aspect >= INSET && aspect < DROP_SHADOW) {
         // The vertex layout of the shape is made so that the derivative is negative from top to
         // middle and positive from middle to bottom.
         lowp float shapeSide = yCoord <= 0.0 ? 0.0 : 1.0;
@@ -74,7 +92,7 @@ void main(void)
         // additive blending since the bevel has already been masked.
         color = (color * vec4(mask[int(shapeSide)])) + vec4(bevel);
 
-    } else if (aspect == DROP_SHADOW) {
+    } else if (aspect >= DROP_SHADOW) {
         // Get the shape mask.
         lowp int shapeSide = yCoord <= 0.0 ? 0 : 1;
         lowp float mask = shapeData[shapeSide];
@@ -85,5 +103,6 @@ void main(void)
         color = (color * vec4(mask)) + vec4(0.0, 0.0, 0.0, shadow);
     }
 
-    gl_FragColor = color * opacityFactors.xxxy;
+    // The pressed aspect is implemented by scaling the final RGB fragment color.
+    gl_FragColor = color * vec4(vec3(parameters.z * opacity), opacity);
 }
@@ -18,29 +18,36 @@ uniform highp mat4 matrix;  // mediump was interpreted as lowp on PowerVR Rogue
 uniform bool textured;
 
 attribute highp vec4 positionAttrib;  // highp because of matrix precision qualifier.
-attribute mediump vec2 shapeCoordAttrib;
+attribute mediump vec3 shapeCoordAttrib;  // The y coordinate is packed in the 3rd component.
 attribute mediump vec4 sourceCoordAttrib;
-attribute lowp float yCoordAttrib;
+attribute mediump vec4 sourceRectAttrib;
 attribute lowp vec4 backgroundColorAttrib;
+attribute lowp vec4 parametersAttrib;
 attribute mediump vec2 overlayCoordAttrib;
 attribute lowp vec4 overlayColorAttrib;
 
 // FIXME(loicm) Optimize by reducing/packing varyings.
 varying mediump vec2 shapeCoord;
 varying mediump vec4 sourceCoord;
+varying mediump vec4 sourceRect;
 varying lowp float yCoord;
 varying lowp vec4 backgroundColor;
+// Per-shape parameters: source opacity, anti-aliasing distance factor, pressed color factor and
+// aspect.
+varying lowp vec4 parameters;
 varying mediump vec2 overlayCoord;
 varying lowp vec4 overlayColor;
 
 void main()
 {
-    shapeCoord = shapeCoordAttrib;
+    shapeCoord = shapeCoordAttrib.st;
     if (textured) {
         sourceCoord = sourceCoordAttrib;
+        sourceRect = sourceRectAttrib;
     }
-    yCoord = yCoordAttrib;
+    yCoord = shapeCoordAttrib.p;
     backgroundColor = backgroundColorAttrib;
+    parameters = parametersAttrib;
     overlayCoord = overlayCoordAttrib;
     overlayColor = overlayColorAttrib;
 
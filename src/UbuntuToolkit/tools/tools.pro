@@ -1,5 +0,0 @@
-TEMPLATE = app
-TARGET = createshapetextures
-QT += gui svg
-QMAKE_CXXFLAGS += -Werror -Wno-unused-variable
-SOURCES += createshapetextures.cpp
@@ -63,6 +63,7 @@
 #include "ucapplication_p.h"
 #include "ucargument_p.h"
 #include "ucarguments_p.h"
+#include "ucasyncimageprovider_p.h"
 #include "ucbottomedge_p.h"
 #include "ucbottomedgehint_p.h"
 #include "ucbottomedgeregion_p.h"
@@ -265,10 +266,24 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
 
     HapticsProxy::instance(engine);
 
-    engine->addImageProvider(QLatin1String("scaling"), new UCScalingImageProvider);
-
-    // register icon provider
-    engine->addImageProvider(QLatin1String("theme"), new UnityThemeIconProvider);
+    // UC_ASYNC_IMAGE_PROVIDERS decodes the images on a thread pool so that
+    // synchronous Image elements don't block the GUI thread. It is opt-in since
+    // it makes all the images asynchronous and their implicit size is then the
+    // size of the decoded image, not the one returned by the provider.
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    if (!qgetenv("UC_ASYNC_IMAGE_PROVIDERS").isEmpty()) {
+        engine->addImageProvider(QLatin1String("scaling"),
+                                 new UCAsyncImageProvider(new UCScalingImageProvider));
+        engine->addImageProvider(QLatin1String("theme"),
+                                 new UCAsyncImageProvider(new UnityThemeIconProvider));
+    } else
+#endif
+    {
+        engine->addImageProvider(QLatin1String("scaling"), new UCScalingImageProvider);
+
+        // register icon provider
+        engine->addImageProvider(QLatin1String("theme"), new UnityThemeIconProvider);
+    }
 
     // Necessary for Screen.orientation (from import QtQuick.Window 2.0) to work
     QGuiApplication::primaryScreen()->setOrientationUpdateMask( Qt::ScreenOrientations(
@@ -300,6 +315,8 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
                 filter |= UMApplicationMonitor::FrameEvent;
             } else if (filterList[i] == QStringLiteral("generic")) {
                 filter |= UMApplicationMonitor::GenericEvent;
+            } else if (filterList[i] == QStringLiteral("thread")) {
+                filter |= UMApplicationMonitor::ThreadEvent;
             }
         }
         applicationMonitor->setLoggingFilter(filter);
@@ -313,6 +330,9 @@ void UbuntuToolkitModule::initializeModule(QQmlEngine *engine, const QUrl &plugi
         } else if (metricsLogging == "lttng") {
             logger = new UMLTTNGLogger();
 #endif  // defined(Q_OS_LINUX)
+        } else if (metricsLogging.startsWith("binary:")) {
+            logger = new UMFileLogger(
+                QString::fromLocal8Bit(metricsLogging.mid(7)), UMFileLogger::Binary);
         } else {
             logger = new UMFileLogger(QString::fromLocal8Bit(metricsLogging));
         }
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ucasyncimageprovider_p.h"
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+
+UT_NAMESPACE_BEGIN
+
+// Decodes an image on the thread pool for all the responses requesting it.
+class UCAsyncImageJob : public QRunnable
+{
+public:
+    UCAsyncImageJob(UCAsyncImageProvider *provider, const QString &key, const QString &id,
+                    const QSize &requestedSize)
+        : m_provider(provider)
+        , m_key(key)
+        , m_id(id)
+        , m_requestedSize(requestedSize)
+    {
+    }
+
+    void run() override
+    {
+        // Don't decode if all the requesting images went away while queued.
+        m_provider->m_mutex.lock();
+        if (m_responses.isEmpty()) {
+            if (m_provider->m_jobs.value(m_key) == this) {
+                m_provider->m_jobs.remove(m_key);
+            }
+            m_provider->m_mutex.unlock();
+            return;
+        }
+        m_provider->m_mutex.unlock();
+
+        QSize size;
+        const QImage image = m_provider->m_provider->requestImage(m_id, &size, m_requestedSize);
+        m_provider->finishJob(this, image);
+    }
+
+    UCAsyncImageProvider *m_provider;
+    QString m_key;
+    QString m_id;
+    QSize m_requestedSize;
+    QList<UCAsyncImageResponse*> m_responses;
+};
+
+class UCAsyncImageResponse : public QQuickImageResponse
+{
+public:
+    UCAsyncImageResponse(UCAsyncImageProvider *provider, UCAsyncImageJob *job)
+        : m_provider(provider)
+        , m_job(job)
+    {
+    }
+
+    ~UCAsyncImageResponse()
+    {
+        UCAsyncImageProvider *provider = m_provider.loadAcquire();
+        if (provider) {
+            provider->cancelResponse(this);
+        }
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override
+    {
+        return m_errorString;
+    }
+
+    // Called by QtQuick when the requesting image is destroyed or changes its
+    // source before the response is finished.
+    void cancel() override
+    {
+        UCAsyncImageProvider *provider = m_provider.loadAcquire();
+        if (provider) {
+            provider->cancelResponse(this);
+        }
+    }
+
+    // Called with the provider mutex locked, from a worker thread. The
+    // response is detached from the provider, which can be destroyed before
+    // the finished response.
+    void finish(const QImage &image, const QString &errorString)
+    {
+        m_provider.storeRelease(nullptr);
+        m_job = nullptr;
+        m_image = image;
+        m_errorString = errorString;
+        Q_EMIT finished();
+    }
+
+    QAtomicPointer<UCAsyncImageProvider> m_provider;
+    UCAsyncImageJob *m_job;
+    QImage m_image;
+    QString m_errorString;
+};
+
+/*!
+    \internal
+
+    The UCAsyncImageProvider class makes a synchronous image provider
+    asynchronous, so that images are never decoded on the GUI thread, even for
+    Image elements that aren't asynchronous.
+
+    Images are decoded on a thread pool bounded to \a maxThreadCount threads
+    (by default one less than the number of cores, up to 4). Requests for an
+    image being decoded (same id and requested size) are coalesced to a single
+    decode, and decodes are skipped if all the requesting images went away
+    before a thread picked them. The most recent requests are decoded first:
+    when scrolling a list, they correspond to the items entering the view while
+    the requests of the items that left it get cancelled.
+*/
+UCAsyncImageProvider::UCAsyncImageProvider(QQuickImageProvider *provider, int maxThreadCount)
+    : QQuickAsyncImageProvider()
+    , m_provider(provider)
+    , m_priority(0)
+{
+    Q_ASSERT(provider && provider->imageType() == QQuickImageProvider::Image);
+    if (maxThreadCount <= 0) {
+        maxThreadCount = qBound(1, QThread::idealThreadCount() - 1, 4);
+    }
+    m_threadPool.setMaxThreadCount(maxThreadCount);
+}
+
+UCAsyncImageProvider::~UCAsyncImageProvider()
+{
+    // Fail the pending responses and let the running jobs finish, queued jobs
+    // are deleted by the thread pool.
+    m_mutex.lock();
+    const QString errorString = QStringLiteral("Image provider destroyed");
+    Q_FOREACH(UCAsyncImageJob *job, m_jobs) {
+        Q_FOREACH(UCAsyncImageResponse *response, job->m_responses) {
+            response->finish(QImage(), errorString);
+        }
+        job->m_responses.clear();
+    }
+    m_jobs.clear();
+    m_mutex.unlock();
+
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
+
+QQuickImageResponse *UCAsyncImageProvider::requestImageResponse(
+    const QString &id, const QSize &requestedSize)
+{
+    const QString key = QStringLiteral("%1@%2x%3").arg(id).arg(requestedSize.width())
+        .arg(requestedSize.height());
+
+    QMutexLocker locker(&m_mutex);
+    UCAsyncImageJob *job = m_jobs.value(key);
+    if (!job) {
+        job = new UCAsyncImageJob(this, key, id, requestedSize);
+        m_jobs.insert(key, job);
+        // Increasing priorities so that the most recent requests run first.
+        m_threadPool.start(job, m_priority);
+        m_priority = (m_priority + 1) & 0x7fffffff;
+    }
+    UCAsyncImageResponse *response = new UCAsyncImageResponse(this, job);
+    job->m_responses.append(response);
+    return response;
+}
+
+void UCAsyncImageProvider::finishJob(UCAsyncImageJob *job, const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_jobs.value(job->m_key) == job) {
+        m_jobs.remove(job->m_key);
+    }
+    const QString errorString = image.isNull() ?
+        QStringLiteral("Failed to get image from provider: %1").arg(job->m_id) : QString();
+    Q_FOREACH(UCAsyncImageResponse *response, job->m_responses) {
+        response->finish(image, errorString);
+    }
+    job->m_responses.clear();
+}
+
+void UCAsyncImageProvider::cancelResponse(UCAsyncImageResponse *response)
+{
+    QMutexLocker locker(&m_mutex);
+    if (response->m_job) {
+        response->m_job->m_responses.removeOne(response);
+        response->m_job = nullptr;
+    }
+}
+
+UT_NAMESPACE_END
+
+#endif  // QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
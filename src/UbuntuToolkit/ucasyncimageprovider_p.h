@@ -0,0 +1,67 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UCASYNCIMAGEPROVIDER_P_H
+#define UCASYNCIMAGEPROVIDER_P_H
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QThreadPool>
+#include <QtQuick/QQuickImageProvider>
+
+#include <UbuntuToolkit/ubuntutoolkitglobal.h>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+
+UT_NAMESPACE_BEGIN
+
+class UCAsyncImageJob;
+class UCAsyncImageResponse;
+
+class UBUNTUTOOLKIT_EXPORT UCAsyncImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    // Takes ownership of the given synchronous image provider, which must be
+    // thread-safe.
+    explicit UCAsyncImageProvider(QQuickImageProvider *provider, int maxThreadCount = -1);
+    ~UCAsyncImageProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize)
+        override;
+
+    QQuickImageProvider *provider() const { return m_provider.data(); }
+    int maxThreadCount() const { return m_threadPool.maxThreadCount(); }
+
+private:
+    void finishJob(UCAsyncImageJob *job, const QImage &image);
+    void cancelResponse(UCAsyncImageResponse *response);
+
+    QScopedPointer<QQuickImageProvider> m_provider;
+    QThreadPool m_threadPool;
+    QMutex m_mutex;
+    QHash<QString, UCAsyncImageJob*> m_jobs;
+    int m_priority;
+
+    friend class UCAsyncImageJob;
+    friend class UCAsyncImageResponse;
+};
+
+UT_NAMESPACE_END
+
+#endif  // QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+
+#endif // UCASYNCIMAGEPROVIDER_P_H
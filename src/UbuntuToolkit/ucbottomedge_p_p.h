@@ -68,6 +68,7 @@ public:
 
     // from UCStyledItemBase
     bool loadStyleItem(bool animated = true) override;
+    bool canIncubateStyleItem() const override { return false; }
     // from QQuickItemChangeListener
     void itemChildAdded(QQuickItem *item, QQuickItem *child) override;
     void itemChildRemoved(QQuickItem *item, QQuickItem *child) override;
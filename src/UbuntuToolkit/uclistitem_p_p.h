@@ -116,6 +116,7 @@ public:
     void setContentMoving(bool moved);
     void preStyleChanged() override;
     bool loadStyleItem(bool animated = true) override;
+    bool canIncubateStyleItem() const override { return false; }
     bool dragging();
     bool dragMode();
     void setDragMode(bool draggable);
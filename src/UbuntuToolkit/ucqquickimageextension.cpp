@@ -28,7 +28,7 @@
 
 UT_NAMESPACE_BEGIN
 
-QHash<QUrl, QSharedPointer<QTemporaryFile> > UCQQuickImageExtension::s_rewrittenSciFiles;
+QHash<QPair<QUrl, QString>, QUrl> UCQQuickImageExtension::s_rewrittenSciUrls;
 
 /*!
     \internal
@@ -97,7 +97,10 @@ void UCQQuickImageExtension::reloadSource()
             || selectedFilePath.endsWith(QStringLiteral(".svg"))
             || selectedFilePath.endsWith(QStringLiteral(".svgz"))) {
             // Take care to pass the original fragment
-            QUrl selectedFileUrl(QUrl::fromLocalFile(selectedFilePath));
+            // Resources (the theme bundles for instance) are resolved to ':' prefixed paths
+            QUrl selectedFileUrl(selectedFilePath.startsWith(QLatin1Char(':'))
+                                 ? QUrl(QStringLiteral("qrc") + selectedFilePath)
+                                 : QUrl::fromLocalFile(selectedFilePath));
             selectedFileUrl.setFragment(fragment);
             m_image->setSource(selectedFileUrl);
         } else {
@@ -114,37 +117,33 @@ void UCQQuickImageExtension::reloadSource()
           // Regular image file
             m_image->setSource(QUrl("image://scaling/" + resolved + fragment));
         } else {
-            // .sci image file. Rewrite the .sci file into a temporary file.
-            bool rewritten = true;
-            QTemporaryFile* rewrittenSciFile;
+            // .sci image file. Rewrite the .sci file in memory and load it
+            // from a data URL.
+            QString sciScaleFactor = scaleFactor;
+            if (!qFuzzyCompare(qGuiApp->devicePixelRatio(), (qreal)1.0)) {
+                sciScaleFactor = QString::number(scaleFactor.toFloat() / qGuiApp->devicePixelRatio());
+            }
 
-            /* Ensure that only one temporary rewritten .sci file is created
-               for each source .sci file by storing the path to the temporary
-               file in a global hash.
+            /* Ensure that each source .sci file is only rewritten once for a
+               given scale factor by storing the rewritten data URLs in a
+               global hash.
             */
-            rewrittenSciFile = UCQQuickImageExtension::s_rewrittenSciFiles.value(m_source).data();
-            if (rewrittenSciFile == NULL) {
-                rewrittenSciFile = new QTemporaryFile;
-                rewrittenSciFile->setFileTemplate(QDir::tempPath() + "/XXXXXX.sci");
-                rewrittenSciFile->open();
-                QTextStream output(rewrittenSciFile);
-
-                if (qFuzzyCompare(qGuiApp->devicePixelRatio(), (qreal)1.0)) {
-                    rewritten = rewriteSciFile(selectedFilePath, scaleFactor, output);
-                } else {
-                    QString scaleFactorInDevicePixels = QString::number(scaleFactor.toFloat() / qGuiApp->devicePixelRatio());
-                    rewritten = rewriteSciFile(selectedFilePath, scaleFactorInDevicePixels, output);
+            const QPair<QUrl, QString> key(m_source, sciScaleFactor);
+            QUrl rewrittenSciUrl = s_rewrittenSciUrls.value(key);
+            if (rewrittenSciUrl.isEmpty()) {
+                QString rewrittenSci;
+                QTextStream output(&rewrittenSci);
+                if (rewriteSciFile(selectedFilePath, sciScaleFactor, output)) {
+                    output.flush();
+                    rewrittenSciUrl = sciDataUrl(rewrittenSci);
+                    s_rewrittenSciUrls.insert(key, rewrittenSciUrl);
                 }
-                rewrittenSciFile->close();
-
-                s_rewrittenSciFiles.insert(m_source, QSharedPointer<QTemporaryFile>(rewrittenSciFile));
             }
 
-            if (rewritten) {
+            if (!rewrittenSciUrl.isEmpty()) {
                 // Take care to pass the original fragment
-                QUrl rewrittenSciFileUrl(QUrl::fromLocalFile(rewrittenSciFile->fileName()));
-                rewrittenSciFileUrl.setFragment(fragment);
-                m_image->setSource(rewrittenSciFileUrl);
+                rewrittenSciUrl.setFragment(fragment);
+                m_image->setSource(rewrittenSciUrl);
             } else {
                 m_image->setSource(m_source);
             }
@@ -176,6 +175,15 @@ bool UCQQuickImageExtension::rewriteSciFile(const QString &sciFilePath, const QS
     }
 }
 
+QUrl UCQQuickImageExtension::sciDataUrl(const QString &sci)
+{
+    // QQuickBorderImage only parses sources with a path ending with "sci", the
+    // trailing comment line takes care of that for data URLs.
+    const QByteArray data = sci.toUtf8() + "#sci";
+    return QUrl(QStringLiteral("data:text/plain;charset=utf-8,")
+                + QString::fromLatin1(QUrl::toPercentEncoding(data)));
+}
+
 QString UCQQuickImageExtension::scaledBorder(const QString &border, const QString &scaleFactor)
 {
     // Rewrite the border line with a scaled border value
@@ -20,9 +20,9 @@
 #define UCQQUICKIMAGEEXTENSION_P_H
 
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
-#include <QtCore/QSharedPointer>
-#include <QtCore/QTemporaryFile>
+#include <QtCore/QPair>
 #include <QtCore/QTextStream>
 #include <QtCore/QUrl>
 
@@ -51,13 +51,14 @@ protected Q_SLOTS:
 
 protected:
     bool rewriteSciFile(const QString &sciFilePath, const QString &scaleFactor, QTextStream& output);
+    QUrl sciDataUrl(const QString &sci);
     QString scaledBorder(const QString &border, const QString &scaleFactor);
     QString scaledSource(QString source, const QString &sciFilePath, const QString &scaleFactor);
 
 private:
     QQuickImageBase* m_image;
     QUrl m_source;
-    static QHash<QUrl, QSharedPointer<QTemporaryFile> > s_rewrittenSciFiles;
+    static QHash<QPair<QUrl, QString>, QUrl> s_rewrittenSciUrls;
 };
 
 UT_NAMESPACE_END
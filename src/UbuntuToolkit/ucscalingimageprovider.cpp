@@ -18,11 +18,56 @@
 
 #include "ucscalingimageprovider_p.h"
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
 #include <QtGui/QImageReader>
 
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 UT_NAMESPACE_BEGIN
 
+// Header of the files stored in the disk cache, followed by the raw pixels of
+// the scaled image so that the files can be mapped in memory and used as is.
+struct DiskCacheHeader {
+    char magic[4];
+    quint32 version;
+    qint32 format;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    // Size returned to QtQuick, which can differ from the image size when a
+    // size is requested.
+    qint32 returnedWidth;
+    qint32 returnedHeight;
+};
+Q_STATIC_ASSERT(sizeof(DiskCacheHeader) == 32);
+
+static const char diskCacheMagic[4] = { 'U', 'C', 'S', 'I' };
+static const quint32 diskCacheVersion = 1;
+static const int defaultMemoryCacheMaxSize = 8 * 1024 * 1024;
+static const qint64 defaultDiskCacheMaxSize = 32 * 1024 * 1024;
+
+struct MappedFile {
+    void *address;
+    size_t size;
+};
+
+static void unmapImageFile(void *info)
+{
+    MappedFile *mappedFile = static_cast<MappedFile*>(info);
+    munmap(mappedFile->address, mappedFile->size);
+    delete mappedFile;
+}
+
 /*!
     \internal
 
@@ -33,9 +78,62 @@ UT_NAMESPACE_BEGIN
 
     Example:
      * image://scaling/0.5/arrow.png
+
+    Scaled images are cached in memory and on disk. Cache entries are keyed by
+    the path, the modification time and size of the file, the scaling factor
+    and the requested size, so that a modified file is never served from the
+    cache. The disk cache (in the generic cache location by default) stores
+    the already scaled pixels which are mapped in memory when read back, the
+    least recently used entries are removed when it grows above its maximum
+    size. Images from Qt resources are only cached in memory.
 */
-UCScalingImageProvider::UCScalingImageProvider() : QQuickImageProvider(QQuickImageProvider::Image)
+UCScalingImageProvider::UCScalingImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_memoryCache(defaultMemoryCacheMaxSize)
+    , m_diskCachePath(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                      + QStringLiteral("/ubuntu-ui-toolkit/scaling"))
+    , m_diskCacheMaxSize(defaultDiskCacheMaxSize)
+    , m_diskCacheSize(-1)
+{
+}
+
+void UCScalingImageProvider::setMemoryCacheMaxSize(int maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_memoryCache.setMaxCost(qMax(0, maxSize));
+}
+
+int UCScalingImageProvider::memoryCacheMaxSize()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryCache.maxCost();
+}
+
+void UCScalingImageProvider::setDiskCachePath(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    if (path != m_diskCachePath) {
+        m_diskCachePath = path;
+        m_diskCacheSize = -1;
+    }
+}
+
+QString UCScalingImageProvider::diskCachePath()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_diskCachePath;
+}
+
+void UCScalingImageProvider::setDiskCacheMaxSize(qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_diskCacheMaxSize = qMax(Q_INT64_C(0), maxSize);
+}
+
+qint64 UCScalingImageProvider::diskCacheMaxSize()
 {
+    QMutexLocker locker(&m_mutex);
+    return m_diskCacheMaxSize;
 }
 
 QImage UCScalingImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
@@ -45,6 +143,58 @@ QImage UCScalingImageProvider::requestImage(const QString &id, QSize *size, cons
     int fragmentPosition = id.lastIndexOf(QStringLiteral("#"));
     int pathLength = fragmentPosition > -1 ? fragmentPosition - separatorPosition - 1 : -1;
     QString path = id.mid(separatorPosition + 1, pathLength);
+
+    QFileInfo fileInfo(path);
+    if (!fileInfo.exists()) {
+        return QImage();
+    }
+    const bool isResource = path.startsWith(QLatin1Char(':'));
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(path.toUtf8());
+    hash.addData(QByteArray::number(isResource ? 0 : fileInfo.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(fileInfo.size()));
+    hash.addData(QByteArray::number(scaleFactor));
+    hash.addData(QByteArray::number(requestedSize.width()));
+    hash.addData(QByteArray::number(requestedSize.height()));
+    const QByteArray key = hash.result().toHex();
+
+    m_mutex.lock();
+    if (CachedImage *cachedImage = m_memoryCache.object(key)) {
+        const QImage image = cachedImage->image;
+        *size = cachedImage->size;
+        m_mutex.unlock();
+        return image;
+    }
+    const QString diskCachePath = isResource ? QString() : m_diskCachePath;
+    m_mutex.unlock();
+
+    CachedImage *cachedImage = new CachedImage;
+    const QString fileName = !diskCachePath.isEmpty() ?
+        diskCachePath + QLatin1Char('/') + QString::fromLatin1(key) : QString();
+    if (fileName.isEmpty() || !readDiskCache(fileName, cachedImage)) {
+        cachedImage->image = readImage(path, scaleFactor, requestedSize, &cachedImage->size);
+        if (cachedImage->image.isNull()) {
+            *size = cachedImage->size;
+            delete cachedImage;
+            return QImage();
+        }
+        if (!fileName.isEmpty()) {
+            writeDiskCache(fileName, *cachedImage);
+        }
+    }
+
+    const QImage image = cachedImage->image;
+    *size = cachedImage->size;
+    m_mutex.lock();
+    m_memoryCache.insert(key, cachedImage, image.byteCount());
+    m_mutex.unlock();
+    return image;
+}
+
+QImage UCScalingImageProvider::readImage(const QString &path, float scaleFactor,
+                                         const QSize &requestedSize, QSize *size)
+{
     QFile file(path);
 
     if (file.open(QIODevice::ReadOnly)) {
@@ -83,4 +233,120 @@ QImage UCScalingImageProvider::requestImage(const QString &id, QSize *size, cons
     }
 }
 
+bool UCScalingImageProvider::readDiskCache(const QString &fileName, CachedImage *cachedImage)
+{
+    const int fd = open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1
+        || fileStat.st_size < static_cast<off_t>(sizeof(DiskCacheHeader))) {
+        close(fd);
+        return false;
+    }
+    void *address = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Update the modification time, used to evict the least recently used
+    // entries.
+    futimens(fd, NULL);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    const DiskCacheHeader *header = static_cast<const DiskCacheHeader*>(address);
+    if (memcmp(header->magic, diskCacheMagic, sizeof(diskCacheMagic))
+        || header->version != diskCacheVersion
+        || header->format <= QImage::Format_Invalid || header->format >= QImage::NImageFormats
+        || header->width <= 0 || header->height <= 0 || header->bytesPerLine <= 0
+        || fileStat.st_size != static_cast<off_t>(
+            sizeof(DiskCacheHeader) + static_cast<qint64>(header->bytesPerLine) * header->height)) {
+        munmap(address, fileStat.st_size);
+        return false;
+    }
+
+    MappedFile *mappedFile = new MappedFile;
+    mappedFile->address = address;
+    mappedFile->size = fileStat.st_size;
+    cachedImage->image = QImage(
+        static_cast<const uchar*>(address) + sizeof(DiskCacheHeader), header->width,
+        header->height, header->bytesPerLine, static_cast<QImage::Format>(header->format),
+        unmapImageFile, mappedFile);
+    cachedImage->size = QSize(header->returnedWidth, header->returnedHeight);
+    return true;
+}
+
+void UCScalingImageProvider::writeDiskCache(const QString &fileName, const CachedImage &cachedImage)
+{
+    // Indexed images would require storing the color table.
+    QImage image = cachedImage.image;
+    if (image.colorCount() > 0) {
+        image = image.convertToFormat(
+            image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    }
+
+    DiskCacheHeader header;
+    memcpy(header.magic, diskCacheMagic, sizeof(diskCacheMagic));
+    header.version = diskCacheVersion;
+    header.format = image.format();
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = image.bytesPerLine();
+    header.returnedWidth = cachedImage.size.width();
+    header.returnedHeight = cachedImage.size.height();
+
+    // QSaveFile writes to a temporary file renamed at commit, concurrent
+    // readers never see partially written entries.
+    const QString path = QFileInfo(fileName).path();
+    QDir().mkpath(path);
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)
+        || file.write(reinterpret_cast<const char*>(image.constBits()), image.byteCount())
+            != image.byteCount()
+        || !file.commit()) {
+        return;
+    }
+
+    m_mutex.lock();
+    if (m_diskCacheSize < 0) {
+        m_diskCacheSize = 0;
+        Q_FOREACH(const QFileInfo &info, QDir(path).entryInfoList(QDir::Files)) {
+            m_diskCacheSize += info.size();
+        }
+    } else {
+        m_diskCacheSize += sizeof(header) + image.byteCount();
+    }
+    const qint64 maxSize = m_diskCacheMaxSize;
+    const bool trim = m_diskCacheSize > maxSize;
+    m_mutex.unlock();
+
+    if (trim) {
+        trimDiskCache(path, maxSize);
+    }
+}
+
+void UCScalingImageProvider::trimDiskCache(const QString &path, qint64 maxSize)
+{
+    // Remove the least recently used entries until the cache is back to 3/4
+    // of its maximum size, so that trimming doesn't happen at each write.
+    const QFileInfoList entries =
+        QDir(path).entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 size = 0;
+    Q_FOREACH(const QFileInfo &info, entries) {
+        size += info.size();
+    }
+    const qint64 targetSize = maxSize * 3 / 4;
+    for (int i = 0; i < entries.size() && size > targetSize; ++i) {
+        if (QFile::remove(entries[i].filePath())) {
+            size -= entries[i].size();
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (path == m_diskCachePath) {
+        m_diskCacheSize = size;
+    }
+}
+
 UT_NAMESPACE_END
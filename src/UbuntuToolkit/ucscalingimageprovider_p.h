@@ -19,6 +19,8 @@
 #ifndef UCSCALINGIMAGEPROVIDER_P_H
 #define UCSCALINGIMAGEPROVIDER_P_H
 
+#include <QtCore/QCache>
+#include <QtCore/QMutex>
 #include <QtGui/QImage>
 #include <QtQuick/QQuickImageProvider>
 
@@ -31,6 +33,34 @@ class UBUNTUTOOLKIT_EXPORT UCScalingImageProvider : public QQuickImageProvider
 public:
     explicit UCScalingImageProvider();
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    // Scaled images are kept in an in-process LRU cache bounded to maxSize
+    // bytes, on top of a disk cache shared between processes and application
+    // launches. An empty disk cache path disables the disk cache.
+    void setMemoryCacheMaxSize(int maxSize);
+    int memoryCacheMaxSize();
+    void setDiskCachePath(const QString &path);
+    QString diskCachePath();
+    void setDiskCacheMaxSize(qint64 maxSize);
+    qint64 diskCacheMaxSize();
+
+private:
+    struct CachedImage {
+        QImage image;
+        QSize size;
+    };
+
+    QImage readImage(const QString &path, float scaleFactor, const QSize &requestedSize,
+                     QSize *size);
+    bool readDiskCache(const QString &fileName, CachedImage *cachedImage);
+    void writeDiskCache(const QString &fileName, const CachedImage &cachedImage);
+    void trimDiskCache(const QString &path, qint64 maxSize);
+
+    QMutex m_mutex;
+    QCache<QByteArray, CachedImage> m_memoryCache;
+    QString m_diskCachePath;
+    qint64 m_diskCacheMaxSize;
+    qint64 m_diskCacheSize;
 };
 
 UT_NAMESPACE_END
@@ -19,6 +19,9 @@
 #include "ucstyleditembase_p_p.h"
 
 #include <QtQml/QQmlEngine>
+#include <QtQml/QQmlIncubator>
+#include <QtQml/QQmlInfo>
+#include <QtQuick/QQuickWindow>
 #include <QtQuick/private/qquickanchors_p.h>
 
 #include "ucstylehints_p.h"
@@ -27,15 +30,61 @@
 
 UT_NAMESPACE_BEGIN
 
+bool UCStyledItemBasePrivate::deferStyles = qEnvironmentVariableIsSet("UC_DEFERRED_STYLES");
+
+// Incubates the style item replacing the current one of a styled item on theme
+// changes. The object is attached to the styled item only once it is ready, the
+// context it is created in is deleted together with it. Finished incubators are
+// deleted later, as they cannot be deleted from their status change.
+class UCStyleIncubator : public QObject, public QQmlIncubator
+{
+public:
+    UCStyleIncubator(UCStyledItemBasePrivate *styledItem, QQmlContext *context, const QUrl &url)
+        : QObject()
+        , QQmlIncubator(Asynchronous)
+        , styledItem(styledItem)
+        , context(context)
+        , url(url)
+    {
+    }
+    ~UCStyleIncubator()
+    {
+        // aborts the incubation, deleting the incomplete object
+        clear();
+        if (context && !context->parent()) {
+            delete context.data();
+        }
+    }
+
+    UCStyledItemBasePrivate *styledItem;
+    QPointer<QQmlContext> context;
+    QUrl url;
+
+protected:
+    void setInitialState(QObject *object) override
+    {
+        QQml_setParent_noEvent(context.data(), object);
+    }
+    void statusChanged(Status status) override
+    {
+        if (status == Ready || status == Error) {
+            styledItem->styleItemIncubated();
+        }
+    }
+};
+
 UCStyledItemBasePrivate::UCStyledItemBasePrivate()
     : oldParentItem(Q_NULLPTR)
     , styleComponent(Q_NULLPTR)
     , styleItem(Q_NULLPTR)
+    , styleIncubator(Q_NULLPTR)
     , styleVersion(0)
     , keyNavigationFocus(false)
     , activeFocusOnPress(false)
     , wasStyleLoaded(false)
     , isFocusScope(true)
+    , styleDeferred(false)
+    , styleQueried(false)
 {
 }
 
@@ -94,6 +143,7 @@ void UCStyledItemBase::setActiveFocusOnTab2(bool v)
 
 UCStyledItemBasePrivate::~UCStyledItemBasePrivate()
 {
+    cancelStyleIncubation();
 }
 
 void UCStyledItemBasePrivate::init()
@@ -296,6 +346,7 @@ void UCStyledItemBasePrivate::setStyle(QQmlComponent *style)
     if (styleComponent == style) {
         return;
     }
+    cancelStyleIncubation();
     preStyleChanged();
     styleComponent = style;
     Q_EMIT q_func()->styleChanged();
@@ -319,6 +370,8 @@ void UCStyledItemBasePrivate::resetStyle()
  * }
  * \endqml
  * \note \l style property has precedence over styleName.
+ * \note When the theme changes, the style item is kept if the new theme resolves
+ * the same style document, otherwise it is replaced once the new one is created.
  */
 QString UCStyledItemBasePrivate::styleName() const
 {
@@ -329,6 +382,7 @@ void UCStyledItemBasePrivate::setStyleName(const QString &name)
     if (name == styleDocument) {
         return;
     }
+    cancelStyleIncubation();
     QString prevName = styleDocument;
     styleDocument = name;
     if (prevName != styleDocument && !styleComponent) {
@@ -364,30 +418,24 @@ bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
         // the style loading is delayed
         return false;
     }
+    if (deferStyleItem()) {
+        return false;
+    }
     Q_Q(UCStyledItemBase);
     // either styleComponent or styleName is valid
     QQmlComponent *component = styleComponent;
     UCTheme *theme = q->getTheme();
     if (!component && theme) {
-        component = theme->createStyleComponent(styleDocument + ".qml", q, styleVersion);
+        // shared by all the items of the theme using the same style
+        component = theme->styleComponent(styleDocument + ".qml", q, styleVersion);
     }
     if (!component) {
         return false;
     }
-    // create context
-    // use creation context as parent to create the context we load the style item with
-    QQmlContext *creationContext = component->creationContext();
-    if (!creationContext) {
-        creationContext = qmlContext(q);
-    }
-    if (creationContext && !creationContext->isValid()) {
-        // we are having the changes in the component being under deletion
+    styleItemContext = createStyleContext(component, animated);
+    if (!styleItemContext) {
         return false;
     }
-    styleItemContext = new QQmlContext(creationContext);
-    styleItemContext->setContextObject(q);
-    styleItemContext->setContextProperty(QStringLiteral("styledItem"), q);
-    styleItemContext->setContextProperty(QStringLiteral("animated"), animated);
     QObject *object = component->beginCreate(styleItemContext);
     if (!object) {
         delete styleItemContext;
@@ -397,24 +445,58 @@ bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
     QQml_setParent_noEvent(styleItemContext, object);
     styleItem = qobject_cast<::QQuickItem*>(object);
     if (styleItem) {
-        QQml_setParent_noEvent(styleItem, q);
-        styleItem->setParentItem(q);
-        // put the style behind evenrything
-        styleItem->setZ(-1);
-        // anchor fill to the styled component
-        QQuickAnchors *styleAnchors = QQuickItemPrivate::get(styleItem)->anchors();
-        styleAnchors->setFill(q);
+        attachStyleItem(styleItem);
     } else {
         delete object;
     }
     component->completeCreate();
-    // delete temporary component
-    if (!styleComponent) {
-        delete component;
+    // theme styles are reused on theme changes if the new theme resolves the same document
+    styleItemUrl = styleComponent ? QUrl() : component->url();
+
+    finishStyleItem(animated);
+    return true;
+}
+
+// creates the context the style item is created in, returns null if the context
+// the component is created in is under deletion
+QQmlContext *UCStyledItemBasePrivate::createStyleContext(QQmlComponent *component, bool animated)
+{
+    Q_Q(UCStyledItemBase);
+    // use creation context as parent to create the context we load the style item with,
+    // the shared theme components have none so the item's context is used
+    QQmlContext *creationContext = styleComponent ? component->creationContext() : Q_NULLPTR;
+    if (!creationContext) {
+        creationContext = qmlContext(q);
+    }
+    if (creationContext && !creationContext->isValid()) {
+        // we are having the changes in the component being under deletion
+        return Q_NULLPTR;
     }
+    QQmlContext *context = new QQmlContext(creationContext);
+    context->setContextObject(q);
+    context->setContextProperty(QStringLiteral("styledItem"), q);
+    context->setContextProperty(QStringLiteral("animated"), animated);
+    return context;
+}
 
+// parents the style item to the styled item, behind its content
+void UCStyledItemBasePrivate::attachStyleItem(QQuickItem *item)
+{
+    Q_Q(UCStyledItemBase);
+    QQml_setParent_noEvent(item, q);
+    item->setParentItem(q);
+    // put the style behind evenrything
+    item->setZ(-1);
+    // anchor fill to the styled component
+    QQuickAnchors *styleAnchors = QQuickItemPrivate::get(item)->anchors();
+    styleAnchors->setFill(q);
+}
+
+void UCStyledItemBasePrivate::finishStyleItem(bool animated)
+{
+    Q_Q(UCStyledItemBase);
     // make sure we reset the animated property to true
-    if (!animated) {
+    if (!animated && styleItemContext) {
         styleItemContext->setContextProperty(QStringLiteral("animated"), true);
     }
 
@@ -422,15 +504,125 @@ bool UCStyledItemBasePrivate::loadStyleItem(bool animated)
     _q_styleResized();
     connectStyleSizeChanges(true);
     Q_EMIT q->styleInstanceChanged();
+}
+
+/*
+ * Reloads the style item on theme changes. The style item is kept when the new
+ * theme resolves the same style document, the bindings on the palette and on
+ * the theme following the change. Explicitly set styles are always recreated.
+ * Otherwise the new style item is incubated
+ * using the incubation controller of the window, which creates it in the time
+ * left from the frames, and replaces the current one once ready. The style is
+ * reloaded synchronously when the window is not shown yet or when the item
+ * post-processes its style item.
+ */
+void UCStyledItemBasePrivate::reloadStyleItem()
+{
+    Q_Q(UCStyledItemBase);
+    cancelStyleIncubation();
+    if (styleItem) {
+        if (styleComponent) {
+            // explicitly set styles are recreated, they may use the theme imperatively
+            if (incubateStyleItem(styleComponent)) {
+                return;
+            }
+        } else {
+            UCTheme *theme = q->getTheme();
+            QQmlComponent *component = theme
+                    ? theme->styleComponent(styleDocument + ".qml", q, styleVersion)
+                    : Q_NULLPTR;
+            if (component && component->url() == styleItemUrl) {
+                return;
+            }
+            if (component && incubateStyleItem(component)) {
+                return;
+            }
+        }
+    }
+    preStyleChanged();
+    postStyleChanged();
+    loadStyleItem();
+}
+
+// starts the incubation of the style item, returns false if the style must be loaded
+// synchronously
+bool UCStyledItemBasePrivate::incubateStyleItem(QQmlComponent *component)
+{
+    Q_Q(UCStyledItemBase);
+    QQmlEngine *engine = qmlEngine(q);
+    if (!canIncubateStyleItem() || !engine || !engine->incubationController()
+            || !q->window() || !q->window()->isVisible()) {
+        return false;
+    }
+    QQmlContext *context = createStyleContext(component, true);
+    if (!context) {
+        return false;
+    }
+    styleIncubator = new UCStyleIncubator(this, context, styleComponent ? QUrl() : component->url());
+    component->create(*styleIncubator, context);
     return true;
 }
 
+// swaps the incubated style item with the current one; the current style item
+// is dropped also when the incubation fails, like when the style fails to load
+// synchronously
+void UCStyledItemBasePrivate::styleItemIncubated()
+{
+    UCStyleIncubator *incubator = styleIncubator;
+    styleIncubator = Q_NULLPTR;
+    incubator->deleteLater();
+
+    preStyleChanged();
+    postStyleChanged();
+    if (incubator->isError()) {
+        qmlInfo(q_func(), incubator->errors());
+        return;
+    }
+    QObject *object = incubator->object();
+    styleItem = qobject_cast<QQuickItem*>(object);
+    if (styleItem) {
+        styleItemContext = incubator->context;
+        styleItemUrl = incubator->url;
+        attachStyleItem(styleItem);
+    } else {
+        // not an item, drop it with its context
+        delete object;
+    }
+    finishStyleItem(true);
+}
+
+void UCStyledItemBasePrivate::cancelStyleIncubation()
+{
+    delete styleIncubator;
+    styleIncubator = Q_NULLPTR;
+}
+
+/*
+ * When deferred styles are enabled, the style item of an item which isn't
+ * effectively visible (hidden itself or sitting in a hidden ancestor like a
+ * non-current page or a closed popover) is only created once the item gets
+ * visible or once the style instance is queried. The implicit size of the
+ * item stays 0 until then.
+ */
+bool UCStyledItemBasePrivate::deferStyleItem()
+{
+    styleDeferred = deferStyles && !styleQueried && !effectiveVisible;
+    return styleDeferred;
+}
+
 /*!
  * \internal
  * Instance of the \l style.
  */
 QQuickItem *UCStyledItemBasePrivate::styleInstance()
 {
+    if (!styleQueried) {
+        // the style of an item queried once is never deferred again
+        styleQueried = true;
+        if (styleDeferred) {
+            loadStyleItem(false);
+        }
+    }
     return styleItem;
 }
 
@@ -506,8 +698,8 @@ void UCStyledItemBasePrivate::_q_styleResized()
 void UCStyledItemBase::preThemeChanged()
 {
     Q_D(UCStyledItemBase);
+    // the style item is kept until the new theme's style is known
     d->wasStyleLoaded = (d->styleItem != Q_NULLPTR);
-    d->preStyleChanged();
 }
 void UCStyledItemBase::postThemeChanged()
 {
@@ -516,8 +708,7 @@ void UCStyledItemBase::postThemeChanged()
     if (!d->wasStyleLoaded) {
         return;
     }
-    d->postStyleChanged();
-    d->loadStyleItem();
+    d->reloadStyleItem();
 }
 
 QString UCStyledItemBasePrivate::propertyForVersion(quint16 version) const
@@ -576,6 +767,11 @@ void UCStyledItemBase::itemChange(ItemChange change, const ItemChangeData &data)
         // Children may retain focus as if it was the StyledItem itself
         if (!hasActiveFocus())
             setKeyNavigationFocus(false);
+    } else if (change == ItemVisibleHasChanged) {
+        Q_D(UCStyledItemBase);
+        if (data.boolValue && d->styleDeferred) {
+            d->loadStyleItem(false);
+        }
     }
 }
 
@@ -31,6 +31,7 @@ class QQuickMouseArea;
 UT_NAMESPACE_BEGIN
 
 class UCStyledItemBase;
+class UCStyleIncubator;
 class UBUNTUTOOLKIT_EXPORT UCStyledItemBasePrivate : public QQuickItemPrivate, public UCImportVersionChecker
 {
     Q_INTERFACES(UT_PREPEND_NAMESPACE(UCThemingExtension))
@@ -61,6 +62,13 @@ public:
     virtual void preStyleChanged();
     virtual void postStyleChanged() {}
     virtual bool loadStyleItem(bool animated = true);
+    bool deferStyleItem();
+    void reloadStyleItem();
+    // ListItem and BottomEdge post-process their style in loadStyleItem()
+    virtual bool canIncubateStyleItem() const { return true; }
+    bool incubateStyleItem(QQmlComponent *component);
+    void styleItemIncubated();
+    void cancelStyleIncubation();
     virtual void completeComponentInitialization();
 
     // from UCImportVersionChecker
@@ -73,15 +81,25 @@ public:
     QQuickItem *oldParentItem;
     QQmlComponent *styleComponent;
     QQuickItem *styleItem;
+    UCStyleIncubator *styleIncubator;
+    QUrl styleItemUrl;
     quint16 styleVersion;
     bool keyNavigationFocus:1;
     bool activeFocusOnPress:1;
     bool wasStyleLoaded:1;
     bool isFocusScope:1;
+    bool styleDeferred:1;
+    bool styleQueried:1;
+
+    // set from the UC_DEFERRED_STYLES environment variable
+    static bool deferStyles;
 
 protected:
 
     void connectStyleSizeChanges(bool attach);
+    QQmlContext *createStyleContext(QQmlComponent *component, bool animated);
+    void attachStyleItem(QQuickItem *item);
+    void finishStyleItem(bool animated);
 };
 
 UT_NAMESPACE_END
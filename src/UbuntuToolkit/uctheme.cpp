@@ -22,6 +22,7 @@
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QLibraryInfo>
+#include <QtCore/QResource>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QTextStream>
 #include <QtGui/QFont>
@@ -148,6 +149,8 @@ UT_NAMESPACE_BEGIN
 static const QString contextTheme = QStringLiteral("theme");
 static const QString themeFolderFormat = QStringLiteral("%1/%2/");
 static const QString parentThemeFile = QStringLiteral("parent_theme");
+static const QString themeBundleFile = QStringLiteral("theme.rcc");
+static const QString themeBundleRoot = QStringLiteral("/ubuntu-ui-toolkit/themes");
 
 quint16 UCTheme::previousVersion = 0;
 
@@ -198,6 +201,50 @@ QStringList themeSearchPath()
     return result;
 }
 
+// returns the path of a theme file usable with QFile and QDir, the file may be
+// located in a theme bundle
+static QString themeFilePath(const QUrl &url)
+{
+    if (url.scheme() == QLatin1String("qrc")) {
+        return QLatin1Char(':') + url.path();
+    }
+    return url.toLocalFile();
+}
+
+static bool themeBundlesEnabled()
+{
+    static const bool disabled = qEnvironmentVariableIsSet("UBUNTU_UI_TOOLKIT_NO_THEME_BUNDLES");
+    return !disabled;
+}
+
+// returns the import path under which the bundles of the themes found in the
+// given search path are mapped
+static QString themeBundleImportPath(const QString &searchPath)
+{
+    return QStringLiteral("qrc:") + themeBundleRoot + QDir(searchPath).absolutePath() + '/';
+}
+
+// maps the prebuilt bundle of a theme folder if installed, returns the URL of
+// the theme folder within the bundle or an invalid URL if there is no bundle
+static QUrl mountThemeBundle(const QString &themeFolder)
+{
+    static QSet<QString> mountedBundles;
+    const QString bundle = themeFolder + themeBundleFile;
+    if (!themeBundlesEnabled() || !QFile::exists(bundle)) {
+        return QUrl();
+    }
+    // the absolute folder keeps the roots of same named themes apart
+    const QString mapRoot = themeBundleRoot + themeFolder;
+    if (!mountedBundles.contains(bundle)) {
+        if (!QResource::registerResource(bundle, mapRoot)) {
+            qWarning() << qPrintable(QStringLiteral("Invalid theme bundle: \"%1\"").arg(bundle));
+            return QUrl();
+        }
+        mountedBundles.insert(bundle);
+    }
+    return QUrl(QStringLiteral("qrc:") + mapRoot);
+}
+
 UCTheme::ThemeRecord pathFromThemeName(QString themeName)
 {
     // the first entry from pathList is the app's current folder
@@ -211,7 +258,10 @@ UCTheme::ThemeRecord pathFromThemeName(QString themeName)
         if (QDir(absoluteThemeFolder).exists()) {
             record.deprecated = QFile::exists(absoluteThemeFolder + "deprecated");
             record.shared = QFile::exists(absoluteThemeFolder + "qmldir");
-            record.path = QUrl::fromLocalFile(absoluteThemeFolder);
+            record.path = mountThemeBundle(absoluteThemeFolder);
+            if (!record.path.isValid()) {
+                record.path = QUrl::fromLocalFile(absoluteThemeFolder);
+            }
             break;
         }
     }
@@ -224,7 +274,7 @@ QString parentThemeName(const UCTheme::ThemeRecord& themePath)
     if (!themePath.isValid()) {
         qWarning() << qPrintable(QStringLiteral("Theme not found: \"%1\"").arg(themePath.name));
     } else {
-        QFile file(themePath.path.resolved(parentThemeFile).toLocalFile());
+        QFile file(themeFilePath(themePath.path.resolved(parentThemeFile)));
         if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
             QTextStream in(&file);
             parentTheme = in.readLine();
@@ -461,6 +511,19 @@ void UCTheme::updateEnginePaths(QQmlEngine *engine)
             engine->addImportPath(path);
         }
     }
+    if (!themeBundlesEnabled()) {
+        return;
+    }
+    // the bundles carry the qmldir of their theme, so imports of a (parent)
+    // theme module resolve to the same qrc files the styles are loaded from
+    // instead of compiling the loose files a second time; added last as the
+    // engine prepends the import paths
+    Q_FOREACH(const QString &path, paths) {
+        const QString bundlePath = themeBundleImportPath(path);
+        if (!engine->importPathList().contains(bundlePath)) {
+            engine->addImportPath(bundlePath);
+        }
+    }
 }
 
 void UCTheme::_q_defaultThemeChanged()
@@ -472,6 +535,9 @@ void UCTheme::_q_defaultThemeChanged()
 void UCTheme::updateThemePaths()
 {
     m_themePaths.clear();
+    m_styleUrls.clear();
+    m_themeFolderEntries.clear();
+    clearStyleComponents();
 
     QString themeName = name();
     while (!themeName.isEmpty()) {
@@ -634,11 +700,29 @@ void UCTheme::resetPalette()
     setPalette(NULL);
 }
 
+/*
+ * Returns the URL of the style document in the theme or in its parents, memoized
+ * until the theme paths change so that only the first lookup of a style hits the
+ * file system. Unknown styles are memoized as well.
+ */
 QUrl UCTheme::styleUrl(const QString& styleName, quint16 version, bool *isFallback)
 {
+    const QPair<QString, quint16> key(styleName, version);
+    QHash<QPair<QString, quint16>, StyleUrl>::const_iterator it = m_styleUrls.constFind(key);
+    if (it == m_styleUrls.constEnd()) {
+        StyleUrl entry;
+        entry.url = resolveStyleUrl(styleName, version, &entry.isFallback);
+        it = m_styleUrls.insert(key, entry);
+    }
     if (isFallback) {
-        (*isFallback) = false;
+        (*isFallback) = it->isFallback;
     }
+    return it->url;
+}
+
+QUrl UCTheme::resolveStyleUrl(const QString& styleName, quint16 version, bool *isFallback)
+{
+    (*isFallback) = false;
 
     // loop through the versions first, so we will look after the style in all
     // the parents, then fall back to the older version
@@ -664,9 +748,9 @@ QUrl UCTheme::styleUrl(const QString& styleName, quint16 version, bool *isFallba
 
             QString versionedName = QStringLiteral("%1.%2/%3").arg(major).arg(minor).arg(styleName);
             styleUrl = themePath.path.resolved(versionedName);
-            if (styleUrl.isValid() && QFile::exists(styleUrl.toLocalFile())) {
+            if (styleUrl.isValid() && styleFileExists(styleUrl)) {
                 // set fallback warning if the theme is shared
-                if (isFallback && themePath.shared && (version != styleVersion)) {
+                if (themePath.shared && (version != styleVersion)) {
                     (*isFallback) = true;
                 }
                 return styleUrl;
@@ -675,7 +759,7 @@ QUrl UCTheme::styleUrl(const QString& styleName, quint16 version, bool *isFallba
             // if we don't get any style, get the non-versioned ones for non-shared and deprecated styles
             if (!themePath.shared || themePath.deprecated) {
                 styleUrl = themePath.path.resolved(styleName);
-                if (styleUrl.isValid() && QFile::exists(styleUrl.toLocalFile())) {
+                if (styleUrl.isValid() && styleFileExists(styleUrl)) {
                     return styleUrl;
                 }
             }
@@ -685,6 +769,24 @@ QUrl UCTheme::styleUrl(const QString& styleName, quint16 version, bool *isFallba
     return QUrl();
 }
 
+// checks the existence of a style file from the listing of its folder, each theme
+// folder being listed once until the theme paths change
+bool UCTheme::styleFileExists(const QUrl& url)
+{
+    const QString path = themeFilePath(url);
+    const int separator = path.lastIndexOf('/');
+    if (separator < 0) {
+        return false;
+    }
+    const QString folder = path.left(separator);
+    QHash<QString, QSet<QString> >::const_iterator it = m_themeFolderEntries.constFind(folder);
+    if (it == m_themeFolderEntries.constEnd()) {
+        const QStringList entries = QDir(folder).entryList(QDir::Files);
+        it = m_themeFolderEntries.insert(folder, QSet<QString>::fromList(entries));
+    }
+    return it->contains(path.mid(separator + 1));
+}
+
 // registers the default theme property to the root context
 void UCTheme::createDefaultTheme(QQmlEngine* engine)
 {
@@ -747,6 +849,37 @@ void UCTheme::checkMixedVersionImports(QQuickItem *item, quint16 version)
  * to \a parent.
  */
 QQmlComponent* UCTheme::createStyleComponent(const QString& styleName, QObject* parent, quint16 version)
+{
+    QQmlComponent *component = loadStyleComponent(styleName, parent, parent, version);
+    if (component) {
+        // set context for the component
+        QQmlEngine::setContextForObject(component, qmlContext(parent));
+    }
+    return component;
+}
+
+/*
+ * Returns the style component named \a styleName for the given \a version. The
+ * component is compiled at the first request and shared by all the styled items
+ * using the same style until the theme paths change. It has no context set, so
+ * the items must instantiate it in their own context. \a parent is used for the
+ * engine and for the warnings.
+ */
+QQmlComponent* UCTheme::styleComponent(const QString& styleName, QObject* parent, quint16 version)
+{
+    const QPair<QString, quint16> key(styleName, version);
+    QQmlComponent *component = m_styleComponents.value(key);
+    if (!component) {
+        component = loadStyleComponent(styleName, parent, this, version);
+        if (component) {
+            m_styleComponents.insert(key, component);
+        }
+    }
+    return component;
+}
+
+// creates the component of a style, owned by owner
+QQmlComponent* UCTheme::loadStyleComponent(const QString& styleName, QObject* parent, QObject* owner, quint16 version)
 {
     QQmlComponent *component = NULL;
     Q_ASSERT(version);
@@ -767,14 +900,11 @@ QQmlComponent* UCTheme::createStyleComponent(const QString& styleName, QObject*
                                    .arg(name()).arg(styleName).arg(MAJOR_VERSION(version)).arg(MINOR_VERSION(version))
                                    .arg(MAJOR_VERSION(LATEST_UITK_VERSION)).arg(MINOR_VERSION(LATEST_UITK_VERSION));
             }
-            component = new QQmlComponent(engine, url, QQmlComponent::PreferSynchronous, parent);
+            component = new QQmlComponent(engine, url, QQmlComponent::PreferSynchronous, owner);
             if (component->isError()) {
                 qmlInfo(parent) << component->errorString();
                 delete component;
                 component = NULL;
-            } else {
-                // set context for the component
-                QQmlEngine::setContextForObject(component, qmlContext(parent));
             }
         } else {
             qmlInfo(parent) <<
@@ -785,6 +915,20 @@ QQmlComponent* UCTheme::createStyleComponent(const QString& styleName, QObject*
     return component;
 }
 
+// drops the shared style components, the style items created from them are not affected;
+// the style incubations still creating from them are cancelled first
+void UCTheme::clearStyleComponents()
+{
+    for (int i = 0; i < m_attachedItems.count(); i++) {
+        UCStyledItemBase *styledItem = qobject_cast<UCStyledItemBase*>(m_attachedItems[i]);
+        if (styledItem) {
+            UCStyledItemBasePrivate::get(styledItem)->cancelStyleIncubation();
+        }
+    }
+    qDeleteAll(m_styleComponents);
+    m_styleComponents.clear();
+}
+
 void UCTheme::loadPalette(QQmlEngine *engine, bool notify)
 {
     if (!engine) {
@@ -20,8 +20,11 @@
 #ifndef UCTHEME_P_H
 #define UCTHEME_P_H
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QPair>
 #include <QtCore/QPointer>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QUrl>
 #include <QtQml/QQmlComponent>
@@ -86,6 +89,8 @@ public:
 
     // internal, used by the deprecated Theme.createStyledComponent()
     QQmlComponent* createStyleComponent(const QString& styleName, QObject* parent, quint16 version = 0);
+    // internal, the component is owned by the theme and shared by all the styled items using it
+    QQmlComponent* styleComponent(const QString& styleName, QObject* parent, quint16 version);
     void attachItem(QQuickItem *item, bool attach);
 
     // helper functions
@@ -115,6 +120,10 @@ private:
     void updateEnginePaths(QQmlEngine *engine);
     void updateThemePaths();
     QUrl styleUrl(const QString& styleName, quint16 version, bool *isFallback = NULL);
+    QUrl resolveStyleUrl(const QString& styleName, quint16 version, bool *isFallback);
+    bool styleFileExists(const QUrl& url);
+    QQmlComponent* loadStyleComponent(const QString& styleName, QObject* parent, QObject* owner, quint16 version);
+    void clearStyleComponents();
     void loadPalette(QQmlEngine *engine, bool notify = true);
     void updateThemedItems();
 
@@ -172,6 +181,13 @@ private:
     QPointer<UCTheme> m_parentTheme;
     QPointer<QObject> m_palette; // the palette might be from the default style if the theme doesn't define palette
     QList<ThemeRecord> m_themePaths;
+    QHash<QPair<QString, quint16>, QQmlComponent*> m_styleComponents;
+    struct StyleUrl {
+        QUrl url;
+        bool isFallback;
+    };
+    QHash<QPair<QString, quint16>, StyleUrl> m_styleUrls;
+    QHash<QString, QSet<QString> > m_themeFolderEntries;
     UCDefaultTheme m_defaultTheme;
     QPODVector<QQuickItem*, 4> m_attachedItems;
     bool m_completed:1;
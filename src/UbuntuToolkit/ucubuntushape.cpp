@@ -29,6 +29,7 @@
 
 #include <math.h>
 
+#include <QtCore/QDebug>
 #include <QtCore/QPointer>
 #include <QtGui/QGuiApplication>
 #include <QtQml/QQmlInfo>
@@ -38,6 +39,7 @@
 #include <QtQuick/private/qquickimage_p.h>
 #undef emit
 
+#include "privates/programbinarycache_p.h"
 #include "quickutils_p.h"
 #include "ubuntutoolkitglobal.h"
 #include "ucunits_p.h"
@@ -68,12 +70,24 @@ ShapeShader::ShapeShader() :
 char const* const* ShapeShader::attributeNames() const
 {
     static char const* const attributes[] = {
-        "positionAttrib", "shapeCoordAttrib", "sourceCoordAttrib", "yCoordAttrib",
-        "backgroundColorAttrib", 0
+        "positionAttrib", "shapeCoordAttrib", "sourceCoordAttrib", "sourceRectAttrib",
+        "backgroundColorAttrib", "parametersAttrib", 0
     };
     return attributes;
 }
 
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+void ShapeShader::compile()
+{
+    // Shared by the overlay shader. Note that the batch renderer doesn't call compile() when it
+    // rewrites the vertex shader of merged batches.
+    if (!ProgramBinaryCache::link(program(), vertexShader(), fragmentShader(), attributeNames())) {
+        qWarning("ShapeShader: Shader compilation failed:");
+        qWarning() << program()->log();
+    }
+}
+#endif
+
 void ShapeShader::initialize()
 {
     QSGMaterialShader::initialize();
@@ -84,11 +98,18 @@ void ShapeShader::initialize()
 
     m_functions = QOpenGLContext::currentContext()->functions();
     m_matrixId = program()->uniformLocation("matrix");
-    m_opacityFactorsId = program()->uniformLocation("opacityFactors");
-    m_sourceOpacityId = program()->uniformLocation("sourceOpacity");
+    m_opacityId = program()->uniformLocation("opacity");
     m_distanceAAId = program()->uniformLocation("distanceAA");
     m_texturedId = program()->uniformLocation("textured");
-    m_aspectId = program()->uniformLocation("aspect");
+    m_sourceHalfTexelId = program()->uniformLocation("sourceHalfTexel");
+
+    if (useDistanceFields()) {
+        // Send anti-aliasing distance in distance field space, needs to be divided by 2 for the
+        // shader. It's multiplied in the shader by the per-shape anti-aliasing factor which is 1
+        // most of the time apart when the radius size is low, it linearly goes from 1 to 0 to make
+        // the corners prettier and to prevent the opacity of the whole shape to slightly lower.
+        program()->setUniformValue(m_distanceAAId, (shapeTextureDistanceAA * distanceAApx) / 2.0f);
+    }
 }
 
 void ShapeShader::updateState(
@@ -96,6 +117,9 @@ void ShapeShader::updateState(
 {
     Q_UNUSED(oldEffect);
 
+    // The per-shape parameters (source opacity, anti-aliasing distance factor, aspect and pressed
+    // color factor) are stored in the vertices, only the textures and the QtQuick engine state
+    // are sent here so that the material is shared by as many shapes as possible.
     ShapeMaterial* material = static_cast<ShapeMaterial*>(newEffect);
     const ShapeMaterial::Data* data = material->constData();
 
@@ -120,37 +144,32 @@ void ShapeShader::updateState(
                 sourceTexture->setVerticalWrapMode(
                     data->flags & ShapeMaterial::Data::VerticallyRepeated ?
                     QSGTexture::Repeat : QSGTexture::ClampToEdge);
+            } else if (!sourceTexture->isAtlasTexture()) {
+                // The texture might have been set to repeat by another shape.
+                sourceTexture->setHorizontalWrapMode(QSGTexture::ClampToEdge);
+                sourceTexture->setVerticalWrapMode(QSGTexture::ClampToEdge);
             }
             m_functions->glActiveTexture(GL_TEXTURE1);
             sourceTexture->bind();
             m_functions->glActiveTexture(GL_TEXTURE0);
-            program()->setUniformValue(m_sourceOpacityId, data->sourceOpacity / 255.0f);
+            // Repeat wrap modes of sources in an atlas are emulated in the shaders, wrapped
+            // coordinates are clamped half a texel inside the texture sub-rectangle.
+            const QSize textureSize = sourceTexture->textureSize();
+            if (!textureSize.isEmpty()) {
+                const QRectF subRect = sourceTexture->normalizedTextureSubRect();
+                program()->setUniformValue(
+                    m_sourceHalfTexelId, QVector2D(0.5f * subRect.width() / textureSize.width(),
+                                                   0.5f * subRect.height() / textureSize.height()));
+            }
             textured = true;
         }
     }
     program()->setUniformValue(m_texturedId, textured);
-    program()->setUniformValue(m_aspectId, data->flags & ShapeMaterial::Data::AspectMask);
-
-    // The pressed aspect is implemented by scaling the final RGB fragment color. It's not a real
-    // blending as it was done before deprecation, so for instance transparent colors remain the
-    // same, but we consider it would be too costly to maintain for a deprecated feature that was
-    // actually only used in the toolkit and never documented. The factor is multiplied with the Qt
-    // opacity to avoid useless operations in the shader.
-    const float opacity = state.opacity();
-    const QVector2D opacityFactorsVector(
-        data->flags & ShapeMaterial::Data::Pressed ? pressedFactor * opacity : opacity, opacity);
-    program()->setUniformValue(m_opacityFactorsId, opacityFactorsVector);
-
-    if (useDistanceFields()) {
-        // Send anti-aliasing distance in distance field space, needs to be divided by 2 for the
-        // shader and by 255 for distanceAAFactor dequantization. The factor is 1 most of the time
-        // apart when the radius size is low, it linearly goes from 1 to 0 to make the corners
-        // prettier and to prevent the opacity of the whole shape to slightly lower.
-        const float distanceAA = (shapeTextureDistanceAA * distanceAApx) / (2.0 * 255.0f);
-        program()->setUniformValue(m_distanceAAId, data->distanceAAFactor * distanceAA);
-    }
 
     // Update QtQuick engine uniforms.
+    if (state.isOpacityDirty()) {
+        program()->setUniformValue(m_opacityId, state.opacity());
+    }
     if (state.isMatrixDirty()) {
         program()->setUniformValue(m_matrixId, state.combinedMatrix());
     }
@@ -172,11 +191,12 @@ static void createShapeTextures(QOpenGLContext* openglContext, quint32* ids)
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, shapeTextureWidth, shapeTextureHeight, 0,
-                         GL_RGBA, GL_UNSIGNED_BYTE, shapeTextureData[i]);
+                         GL_RGBA, GL_UNSIGNED_BYTE, shapeTextureData(i));
         }
     } else {
         // Create mipmap textures.
         for (int i = 0; i < shapeTextureCount; i++) {
+            const quint8* data = shapeTextureMipmapData(i);
             glBindTexture(GL_TEXTURE_2D, ids[i]);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -185,7 +205,7 @@ static void createShapeTextures(QOpenGLContext* openglContext, quint32* ids)
             for (int j = 0; j < shapeTextureMipmapCount; j++) {
                 glTexImage2D(GL_TEXTURE_2D, j, GL_RGBA, shapeTextureMipmapWidth >> j,
                              shapeTextureMipmapHeight >> j, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                             &shapeTextureMipmapData[i][shapeTextureMipmapOffset[j]]);
+                             &data[shapeTextureMipmapOffset[j]]);
             }
         }
     }
@@ -249,9 +269,11 @@ QSGMaterialShader* ShapeMaterial::createShader() const
 
 int ShapeMaterial::compare(const QSGMaterial* other) const
 {
-    // Repeat wrap modes require textures to be extracted from their atlases. Since we just store
-    // the texture provider in the material data (not the texture as we want to do the extraction at
-    // QSGShader::updateState() time), we make the comparison fail when repeat wrapping is set.
+    // The material data only stores what can't be stored in the vertices (the textures), shapes
+    // with the same source and shape texture are batched whatever their other properties are.
+    // Hardware repeat wrap modes require textures to be extracted from their atlases. Since we
+    // just store the texture provider in the material data (not the texture as we want to do the
+    // extraction at QSGShader::updateState() time), we make the comparison fail in that case.
     const ShapeMaterial::Data* otherData = static_cast<const ShapeMaterial*>(other)->constData();
     return memcmp(&m_data, otherData, sizeof(m_data))
         | (m_data.flags & ShapeMaterial::Data::Repeated);
@@ -275,6 +297,7 @@ ShapeNode::ShapeNode()
 {
     QSGNode::setFlag(UsePreprocess, true);
     memcpy(m_geometry.indexData(), indices(), indexCount * indexTypeSize);
+    memset(m_geometry.vertexData(), 0x00, vertexCount * sizeof(Vertex));
     m_geometry.setDrawingMode(drawingMode);
     m_geometry.setIndexDataPattern(indexDataPattern);
     m_geometry.setVertexDataPattern(vertexDataPattern);
@@ -302,18 +325,32 @@ const unsigned short* ShapeNode::indices()
     return indices;
 }
 
+// static
+void ShapeNode::updateVertices(QSGGeometryNode* node, QSGGeometry* geometry, const void* vertices)
+{
+    // The vertex data uses the static pattern so that it isn't uploaded at each frame, it's only
+    // copied and marked dirty when it actually changed.
+    const int size = geometry->vertexCount() * geometry->sizeOfVertex();
+    if (memcmp(geometry->vertexData(), vertices, size) != 0) {
+        memcpy(geometry->vertexData(), vertices, size);
+        geometry->markVertexDataDirty();
+        node->markDirty(QSGNode::DirtyGeometry);
+    }
+}
+
 // static
 const QSGGeometry::AttributeSet& ShapeNode::attributeSet()
 {
     static const QSGGeometry::Attribute attributes[] = {
         QSGGeometry::Attribute::create(0, 2, GL_FLOAT, true),
-        QSGGeometry::Attribute::create(1, 2, GL_FLOAT),
+        QSGGeometry::Attribute::create(1, 3, GL_FLOAT),
         QSGGeometry::Attribute::create(2, 4, GL_FLOAT),
-        QSGGeometry::Attribute::create(3, 1, GL_FLOAT),
-        QSGGeometry::Attribute::create(4, 4, GL_UNSIGNED_BYTE)
+        QSGGeometry::Attribute::create(3, 4, GL_FLOAT),
+        QSGGeometry::Attribute::create(4, 4, GL_UNSIGNED_BYTE),
+        QSGGeometry::Attribute::create(5, 4, GL_UNSIGNED_BYTE)
     };
     static const QSGGeometry::AttributeSet attributeSet = {
-        5, sizeof(Vertex), attributes
+        6, sizeof(Vertex), attributes
     };
     return attributeSet;
 }
@@ -608,13 +645,14 @@ void UCUbuntuShape::setSourceFillMode(UCUbuntuShape::FillMode sourceFillMode)
     texture might not cover the entire UbuntuShape area. This property defines how the source
     texture wraps outside of its content area. The default value is \c UbuntuShape.Transparent.
 
-    Ensure \c UbuntuShape.Repeat is used only when necessary (in case of an \c Image or \c
-    AnimatedImage source) as it requires the underlying texture to be extracted from its atlas. That
-    slows down the rendering speed since it prevents the QtQuick renderer to batch the UbuntuShape
-    with others.
+    \c UbuntuShape.Repeat is emulated in the shaders for source textures stored in an atlas (like
+    the ones of small \c Image and \c AnimatedImage sources), so that the UbuntuShape can still be
+    batched with others by the QtQuick renderer and non-power-of-two sized textures are supported.
+    Mipmapped sources and sources not in an atlas are repeated by the GPU instead, which prevents
+    batching and requires mipmapped textures to be extracted from their atlas.
 
     \note Some OpenGL ES 2 implementations do not support \c UbuntuShape.Repeat with
-    non-power-of-two sized source textures.
+    non-power-of-two sized source textures repeated by the GPU.
     \note Setting this disables support for the deprecated \l image property.
 
     \list
@@ -1180,6 +1218,14 @@ static quint32 averageColor(QRgb c1, QRgb c2)
         (qGreen(c1) + qGreen(c2)) >> 1, (qRed(c1) + qRed(c2)) >> 1);
 }
 
+// Whether the repeat wrap modes of a source texture must be handled by the GPU. The wrapping is
+// emulated in the shaders for textures in an atlas, except for mipmapped ones since wrapped
+// coordinates break the screen-space derivatives used to select the mipmap level at the seams.
+static bool useHardwareRepeat(QSGTexture* texture)
+{
+    return !texture->isAtlasTexture() || texture->hasMipmaps();
+}
+
 QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data)
 {
     Q_UNUSED(data);
@@ -1198,8 +1244,19 @@ QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* d
     QSGTexture* sourceTexture = provider ? provider->texture() : NULL;
     QRectF sourceTextureRect(0.0f, 0.0f, 1.0f, 1.0f);
     if (sourceTexture) {
-        if (m_sourceHorizontalWrapMode == Transparent && m_sourceVerticalWrapMode == Transparent) {
+        // Sources in a texture atlas are used as is, even with repeat wrap modes, the texture
+        // sub-rectangle being used in the shaders to emulate the wrapping. Repeated axes are
+        // flagged by a negative size. Sources repeated by the GPU are mapped entirely.
+        const bool repeated = m_sourceHorizontalWrapMode == Repeat
+            || m_sourceVerticalWrapMode == Repeat;
+        if (!repeated || !useHardwareRepeat(sourceTexture)) {
             sourceTextureRect = sourceTexture->normalizedTextureSubRect();
+            if (m_sourceHorizontalWrapMode == Repeat) {
+                sourceTextureRect.setWidth(-sourceTextureRect.width());
+            }
+            if (m_sourceVerticalWrapMode == Repeat) {
+                sourceTextureRect.setHeight(-sourceTextureRect.height());
+            }
         }
         if (m_flags & DirtySourceTransform) {
             const float dpr = qGuiApp->devicePixelRatio();
@@ -1251,14 +1308,8 @@ QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* d
                      / qGuiApp->devicePixelRatio();
     }
 
-    updateMaterial(node, radius, m_aspect != DropShadow ? 0 : 1, sourceTexture && m_sourceOpacity);
-
-    // Get the affine transformation for the source texture coordinates.
-    const QVector4D sourceCoordTransform(
-        m_sourceTransform.x() * sourceTextureRect.width(),
-        m_sourceTransform.y() * sourceTextureRect.height(),
-        m_sourceTransform.z() * sourceTextureRect.width() + sourceTextureRect.x(),
-        m_sourceTransform.w() * sourceTextureRect.height() + sourceTextureRect.y());
+    const bool textured = sourceTexture && m_sourceOpacity;
+    updateMaterial(node, m_aspect != DropShadow ? 0 : 1, textured);
 
     // Get the affine transformation for the source mask coordinates, pixels lying inside the mask
     // (values in the range [-1, 1]) will be textured in the fragment shader. In case of a repeat
@@ -1294,9 +1345,11 @@ QSGNode* UCUbuntuShape::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* d
         packColor(qAlpha(color[1]), qBlue(color[1]), qGreen(color[1]), qRed(color[1]))
     };
 
+    // The affine transformation for the source coordinates is given in normalized source space,
+    // the shaders map the coordinates to the texture sub-rectangle.
     updateGeometry(
-        node, itemSize, radius, shapeTextureOffset, sourceCoordTransform, sourceMaskTransform,
-        backgroundColor);
+        node, itemSize, radius, shapeTextureOffset, m_sourceTransform, sourceMaskTransform,
+        sourceTextureRect, backgroundColor, shapeParameters(radius, textured));
 
     return node;
 }
@@ -1306,65 +1359,85 @@ QSGNode* UCUbuntuShape::createSceneGraphNode() const
     return new ShapeNode;
 }
 
-void UCUbuntuShape::updateMaterial(
-    QSGNode* node, float radius, quint8 shapeTextureIndex, bool textured)
+void UCUbuntuShape::updateMaterial(QSGNode* node, quint8 shapeTextureIndex, bool textured)
 {
-    ShapeMaterial::Data* materialData = static_cast<ShapeNode*>(node)->material()->data();
+    // The whole struct (with the padding bytes) must be initialized for memcmp() to work.
+    ShapeMaterial::Data newData;
+    memset(&newData, 0x00, sizeof(ShapeMaterial::Data));
     quint8 flags = 0;
 
-    materialData->shapeTextureIndex = shapeTextureIndex;
+    newData.shapeTextureIndex = shapeTextureIndex;
     if (textured) {
-        materialData->sourceTextureProvider = m_sourceTextureProvider;
-        materialData->sourceOpacity = m_sourceOpacity;
-        if (m_sourceHorizontalWrapMode == Repeat) {
-            flags |= ShapeMaterial::Data::HorizontallyRepeated;
-        }
-        if (m_sourceVerticalWrapMode == Repeat) {
-            flags |= ShapeMaterial::Data::VerticallyRepeated;
+        newData.sourceTextureProvider = m_sourceTextureProvider;
+        if (useHardwareRepeat(m_sourceTextureProvider->texture())) {
+            if (m_sourceHorizontalWrapMode == Repeat) {
+                flags |= ShapeMaterial::Data::HorizontallyRepeated;
+            }
+            if (m_sourceVerticalWrapMode == Repeat) {
+                flags |= ShapeMaterial::Data::VerticallyRepeated;
+            }
         }
         flags |= ShapeMaterial::Data::Textured;
     } else {
-        materialData->sourceTextureProvider = NULL;
-        materialData->sourceOpacity = 0;
+        newData.sourceTextureProvider = NULL;
     }
+    newData.flags = flags;
+
+    // The geometry isn't marked dirty anymore at each update, so the renderer must be notified
+    // of material changes for the batches to be updated.
+    ShapeMaterial::Data* materialData = static_cast<ShapeNode*>(node)->material()->data();
+    if (memcmp(materialData, &newData, sizeof(ShapeMaterial::Data)) != 0) {
+        memcpy(materialData, &newData, sizeof(ShapeMaterial::Data));
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+}
 
+// Get the per-shape parameters packed for the vertices.
+quint32 UCUbuntuShape::shapeParameters(float radius, bool textured) const
+{
     const float physicalRadius = radius * qGuiApp->devicePixelRatio();
 
     // Mapping of radius size range from [0, 4] to [0, 1] with clamping, plus quantization.
     const float start = 0.0f + radiusSizeOffset;
     const float end = 4.0f + radiusSizeOffset;
+    const quint8 distanceAAFactor =
+        qMax(qMin((physicalRadius / (end - start)) - (start / (end - start)), 1.0f), 0.0f)
+        * 255.0f;
 
-    materialData->distanceAAFactor =
-        qMin((physicalRadius / (end - start)) - (start / (end - start)), 1.0f) * 255.0f;
+    // The pressed aspect is implemented by scaling the final RGB fragment color. It's not a real
+    // blending as it was done before deprecation, so for instance transparent colors remain the
+    // same, but we consider it would be too costly to maintain for a deprecated feature that was
+    // actually only used in the toolkit and never documented.
+    const quint8 pressed = (m_aspect == Pressed) ? pressedFactor * 255.0f : 255;
 
     // When the radius is equal to radiusSizeOffset (which means radius size is 0), no aspect is
-    // flagged so that a dedicated (statically flow controlled) shaved off shader can be used for
-    // optimal performance.
+    // set so that the shaved off code path of the shaders is used for optimal performance.
+    ShapeNode::Aspect aspect = ShapeNode::NoAspect;
     if (physicalRadius > radiusSizeOffset) {
-        const quint8 aspectFlags[] = {
-            ShapeMaterial::Data::Flat, ShapeMaterial::Data::Inset, ShapeMaterial::Data::DropShadow,
-            ShapeMaterial::Data::Inset | ShapeMaterial::Data::Pressed
+        const ShapeNode::Aspect aspects[] = {
+            ShapeNode::Flat, ShapeNode::Inset, ShapeNode::DropShadow, ShapeNode::Inset
         };
-        flags |= aspectFlags[m_aspect];
-    } else {
-        const quint8 aspectFlags[] = { 0, 0, 0, ShapeMaterial::Data::Pressed };
-        flags |= aspectFlags[m_aspect];
+        aspect = aspects[m_aspect];
     }
 
-    materialData->flags = flags;
+    return ShapeNode::packParameters(
+        textured ? m_sourceOpacity : 0, distanceAAFactor, pressed, aspect);
 }
 
 void UCUbuntuShape::updateGeometry(
     QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
     const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-    const quint32 backgroundColor[3])
+    const QRectF& sourceRect, const quint32 backgroundColor[3], quint32 parameters)
 {
     // Used by subclasses, using the shapeTextureOffset constant directly allows slightly
     // better optimization here.
     Q_UNUSED(shapeOffset);
 
-    ShapeNode::Vertex* v = reinterpret_cast<ShapeNode::Vertex*>(
-        static_cast<ShapeNode*>(node)->geometry()->vertexData());
+    ShapeNode::Vertex v[ShapeNode::vertexCount];
+    const float sourceRectX = sourceRect.x();
+    const float sourceRectY = sourceRect.y();
+    const float sourceRectWidth = sourceRect.width();
+    const float sourceRectHeight = sourceRect.height();
 
     // Set top row of 3 vertices.
     v[0].position[0] = 0.0f;
@@ -1375,8 +1448,13 @@ void UCUbuntuShape::updateGeometry(
     v[0].sourceCoordinate[1] = sourceCoordTransform.w();
     v[0].sourceCoordinate[2] = sourceMaskTransform.z();
     v[0].sourceCoordinate[3] = sourceMaskTransform.w();
+    v[0].sourceRect[0] = sourceRectX;
+    v[0].sourceRect[1] = sourceRectY;
+    v[0].sourceRect[2] = sourceRectWidth;
+    v[0].sourceRect[3] = sourceRectHeight;
     v[0].yCoordinate = -1.0f;
     v[0].backgroundColor = backgroundColor[0];
+    v[0].parameters = parameters;
     v[1].position[0] = 0.5f * itemSize.width();
     v[1].position[1] = 0.0f;
     v[1].shapeCoordinate[0] = (0.5f * itemSize.width()) / radius - shapeTextureOffset;
@@ -1385,8 +1463,13 @@ void UCUbuntuShape::updateGeometry(
     v[1].sourceCoordinate[1] = sourceCoordTransform.w();
     v[1].sourceCoordinate[2] = 0.5f * sourceMaskTransform.x() + sourceMaskTransform.z();
     v[1].sourceCoordinate[3] = sourceMaskTransform.w();
+    v[1].sourceRect[0] = sourceRectX;
+    v[1].sourceRect[1] = sourceRectY;
+    v[1].sourceRect[2] = sourceRectWidth;
+    v[1].sourceRect[3] = sourceRectHeight;
     v[1].yCoordinate = -1.0f;
     v[1].backgroundColor = backgroundColor[0];
+    v[1].parameters = parameters;
     v[2].position[0] = itemSize.width();
     v[2].position[1] = 0.0f;
     v[2].shapeCoordinate[0] = shapeTextureOffset;
@@ -1395,8 +1478,13 @@ void UCUbuntuShape::updateGeometry(
     v[2].sourceCoordinate[1] = sourceCoordTransform.w();
     v[2].sourceCoordinate[2] = sourceMaskTransform.x() + sourceMaskTransform.z();
     v[2].sourceCoordinate[3] = sourceMaskTransform.w();
+    v[2].sourceRect[0] = sourceRectX;
+    v[2].sourceRect[1] = sourceRectY;
+    v[2].sourceRect[2] = sourceRectWidth;
+    v[2].sourceRect[3] = sourceRectHeight;
     v[2].yCoordinate = -1.0f;
     v[2].backgroundColor = backgroundColor[0];
+    v[2].parameters = parameters;
 
     // Set middle row of 3 vertices.
     v[3].position[0] = 0.0f;
@@ -1407,8 +1495,13 @@ void UCUbuntuShape::updateGeometry(
     v[3].sourceCoordinate[1] = 0.5f * sourceCoordTransform.y() + sourceCoordTransform.w();
     v[3].sourceCoordinate[2] = sourceMaskTransform.z();
     v[3].sourceCoordinate[3] = 0.5f * sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[3].sourceRect[0] = sourceRectX;
+    v[3].sourceRect[1] = sourceRectY;
+    v[3].sourceRect[2] = sourceRectWidth;
+    v[3].sourceRect[3] = sourceRectHeight;
     v[3].yCoordinate = 0.0f;
     v[3].backgroundColor = backgroundColor[1];
+    v[3].parameters = parameters;
     v[4].position[0] = 0.5f * itemSize.width();
     v[4].position[1] = 0.5f * itemSize.height();
     v[4].shapeCoordinate[0] = (0.5f * itemSize.width()) / radius - shapeTextureOffset;
@@ -1417,8 +1510,13 @@ void UCUbuntuShape::updateGeometry(
     v[4].sourceCoordinate[1] = 0.5f * sourceCoordTransform.y() + sourceCoordTransform.w();
     v[4].sourceCoordinate[2] = 0.5f * sourceMaskTransform.x() + sourceMaskTransform.z();
     v[4].sourceCoordinate[3] = 0.5f * sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[4].sourceRect[0] = sourceRectX;
+    v[4].sourceRect[1] = sourceRectY;
+    v[4].sourceRect[2] = sourceRectWidth;
+    v[4].sourceRect[3] = sourceRectHeight;
     v[4].yCoordinate = 0.0f;
     v[4].backgroundColor = backgroundColor[1];
+    v[4].parameters = parameters;
     v[5].position[0] = itemSize.width();
     v[5].position[1] = 0.5f * itemSize.height();
     v[5].shapeCoordinate[0] = shapeTextureOffset;
@@ -1427,8 +1525,13 @@ void UCUbuntuShape::updateGeometry(
     v[5].sourceCoordinate[1] = 0.5f * sourceCoordTransform.y() + sourceCoordTransform.w();
     v[5].sourceCoordinate[2] = sourceMaskTransform.x() + sourceMaskTransform.z();
     v[5].sourceCoordinate[3] = 0.5f * sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[5].sourceRect[0] = sourceRectX;
+    v[5].sourceRect[1] = sourceRectY;
+    v[5].sourceRect[2] = sourceRectWidth;
+    v[5].sourceRect[3] = sourceRectHeight;
     v[5].yCoordinate = 0.0f;
     v[5].backgroundColor = backgroundColor[1];
+    v[5].parameters = parameters;
 
     // Set bottom row of 3 vertices.
     v[6].position[0] = 0.0f;
@@ -1439,8 +1542,13 @@ void UCUbuntuShape::updateGeometry(
     v[6].sourceCoordinate[1] = sourceCoordTransform.y() + sourceCoordTransform.w();
     v[6].sourceCoordinate[2] = sourceMaskTransform.z();
     v[6].sourceCoordinate[3] = sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[6].sourceRect[0] = sourceRectX;
+    v[6].sourceRect[1] = sourceRectY;
+    v[6].sourceRect[2] = sourceRectWidth;
+    v[6].sourceRect[3] = sourceRectHeight;
     v[6].yCoordinate = 1.0f;
     v[6].backgroundColor = backgroundColor[2];
+    v[6].parameters = parameters;
     v[7].position[0] = 0.5f * itemSize.width();
     v[7].position[1] = itemSize.height();
     v[7].shapeCoordinate[0] = (0.5f * itemSize.width()) / radius - shapeTextureOffset;
@@ -1449,8 +1557,13 @@ void UCUbuntuShape::updateGeometry(
     v[7].sourceCoordinate[1] = sourceCoordTransform.y() + sourceCoordTransform.w();
     v[7].sourceCoordinate[2] = 0.5f * sourceMaskTransform.x() + sourceMaskTransform.z();
     v[7].sourceCoordinate[3] = sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[7].sourceRect[0] = sourceRectX;
+    v[7].sourceRect[1] = sourceRectY;
+    v[7].sourceRect[2] = sourceRectWidth;
+    v[7].sourceRect[3] = sourceRectHeight;
     v[7].yCoordinate = 1.0f;
     v[7].backgroundColor = backgroundColor[2];
+    v[7].parameters = parameters;
     v[8].position[0] = itemSize.width();
     v[8].position[1] = itemSize.height();
     v[8].shapeCoordinate[0] = shapeTextureOffset;
@@ -1459,10 +1572,16 @@ void UCUbuntuShape::updateGeometry(
     v[8].sourceCoordinate[1] = sourceCoordTransform.y() + sourceCoordTransform.w();
     v[8].sourceCoordinate[2] = sourceMaskTransform.x() + sourceMaskTransform.z();
     v[8].sourceCoordinate[3] = sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[8].sourceRect[0] = sourceRectX;
+    v[8].sourceRect[1] = sourceRectY;
+    v[8].sourceRect[2] = sourceRectWidth;
+    v[8].sourceRect[3] = sourceRectHeight;
     v[8].yCoordinate = 1.0f;
     v[8].backgroundColor = backgroundColor[2];
+    v[8].parameters = parameters;
 
-    node->markDirty(QSGNode::DirtyGeometry);
+    ShapeNode* shapeNode = static_cast<ShapeNode*>(node);
+    ShapeNode::updateVertices(shapeNode, shapeNode->geometry(), v);
 }
 
 UT_NAMESPACE_END
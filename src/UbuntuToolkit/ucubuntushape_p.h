@@ -41,15 +41,19 @@ public:
         const RenderState& state, QSGMaterial* newEffect, QSGMaterial* oldEffect) override;
     bool useDistanceFields() const { return m_useDistanceFields; }
 
+protected:
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+    void compile() override;
+#endif
+
 private:
     QOpenGLFunctions* m_functions;
     bool m_useDistanceFields;
     int m_matrixId;
-    int m_opacityFactorsId;
-    int m_sourceOpacityId;
+    int m_opacityId;
     int m_distanceAAId;
     int m_texturedId;
-    int m_aspectId;
+    int m_sourceHalfTexelId;
 };
 
 // --- Scene graph material ---
@@ -62,17 +66,10 @@ public:
             Textured             = (1 << 0),
             HorizontallyRepeated = (1 << 1),
             VerticallyRepeated   = (1 << 2),
-            Repeated             = (HorizontallyRepeated | VerticallyRepeated),
-            Flat                 = (1 << 3),
-            Inset                = (1 << 4),
-            DropShadow           = (1 << 5),
-            AspectMask           = (Flat | Inset | DropShadow),
-            Pressed              = (1 << 6)
+            Repeated             = (HorizontallyRepeated | VerticallyRepeated)
         };
         QSGTextureProvider* sourceTextureProvider;
         quint8 shapeTextureIndex;
-        quint8 distanceAAFactor;
-        quint8 sourceOpacity;
         quint8 flags;
     };
 
@@ -96,23 +93,36 @@ private:
 class ShapeNode : public QSGGeometryNode
 {
 public:
+    // yCoordinate follows shapeCoordinate so that both are fetched as a single attribute.
     struct Vertex {
         float position[2];
         float shapeCoordinate[2];
-        float sourceCoordinate[4];
         float yCoordinate;
+        float sourceCoordinate[4];
+        float sourceRect[4];
         quint32 backgroundColor;
+        quint32 parameters;
     };
 
+    // Per-shape parameters are stored in the vertices (instead of the material) so that shapes
+    // with different parameters can be batched. They are packed as 4 normalized bytes: source
+    // opacity, anti-aliasing distance factor, pressed color factor and aspect.
+    enum Aspect { NoAspect = 0x00, Flat = 0x55, Inset = 0xaa, DropShadow = 0xff };
+    static quint32 packParameters(
+        quint8 sourceOpacity, quint8 distanceAAFactor, quint8 pressedFactor, Aspect aspect) {
+        return (static_cast<quint32>(aspect) << 24) | (static_cast<quint32>(pressedFactor) << 16)
+            | (static_cast<quint32>(distanceAAFactor) << 8) | sourceOpacity; }
+
     static const int indexCount = 14;
     static const int indexType = GL_UNSIGNED_SHORT;
     static const int indexTypeSize = sizeof(unsigned short);
     static const int vertexCount = 9;
     static const QSGGeometry::DataPattern indexDataPattern = QSGGeometry::StaticPattern;
-    static const QSGGeometry::DataPattern vertexDataPattern = QSGGeometry::AlwaysUploadPattern;
+    static const QSGGeometry::DataPattern vertexDataPattern = QSGGeometry::StaticPattern;
     static const GLenum drawingMode = GL_TRIANGLE_STRIP;
     static const unsigned short* indices();
     static const QSGGeometry::AttributeSet& attributeSet();
+    static void updateVertices(QSGGeometryNode* node, QSGGeometry* geometry, const void* vertices);
 
     ShapeNode();
     ShapeMaterial* material() { return &m_material; }
@@ -302,12 +312,11 @@ protected:
 
     // Virtual functions for extended shapes.
     virtual QSGNode* createSceneGraphNode() const;
-    virtual void updateMaterial(
-        QSGNode* node, float radius, quint8 shapeTextureIndex, bool textured);
+    virtual void updateMaterial(QSGNode* node, quint8 shapeTextureIndex, bool textured);
     virtual void updateGeometry(
         QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
         const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-        const quint32 backgroundColor[3]);
+        const QRectF& sourceRect, const quint32 backgroundColor[3], quint32 parameters);
 
 private Q_SLOTS:
     void _q_imagePropertiesChanged();
@@ -317,6 +326,7 @@ private Q_SLOTS:
 
 private:
     bool isVersionGreaterThanOrEqual(Version version);
+    quint32 shapeParameters(float radius, bool textured) const;
     void updateFromImageProperties(QQuickItem* image);
     void connectToPropertyChange(
         QObject* sender, const char* property, QObject* receiver, const char* slot);
@@ -16,9 +16,8 @@
  * Author: Loïc Molinari <loic.molinari@canonical.com>
  */
 
-// FIXME(loicm) Overlay data is passed as geometry and interpolated as varying so that it can be
-//     batched. It would be very useful to implement it with uniforms and compare the perf by
-//     plotting the rendering speed of a scene with an increasing number of overlaid shapes.
+// Overlay data is passed as geometry and interpolated as varying, like the other per-shape
+// parameters, so that overlaid shapes can be batched whatever their overlay is.
 
 #include "ucubuntushapeoverlay_p.h"
 
@@ -37,8 +36,8 @@ ShapeOverlayShader::ShapeOverlayShader()
 char const* const* ShapeOverlayShader::attributeNames() const
 {
     static char const* const attributes[] = {
-        "positionAttrib", "shapeCoordAttrib", "sourceCoordAttrib", "yCoordAttrib",
-        "backgroundColorAttrib", "overlayCoordAttrib", "overlayColorAttrib", 0
+        "positionAttrib", "shapeCoordAttrib", "sourceCoordAttrib", "sourceRectAttrib",
+        "backgroundColorAttrib", "parametersAttrib", "overlayCoordAttrib", "overlayColorAttrib", 0
     };
     return attributes;
 }
@@ -67,6 +66,7 @@ ShapeOverlayNode::ShapeOverlayNode()
     QSGNode::setFlag(UsePreprocess, true);
     memcpy(m_geometry.indexData(), ShapeNode::indices(),
            ShapeNode::indexCount * ShapeNode::indexTypeSize);
+    memset(m_geometry.vertexData(), 0x00, ShapeNode::vertexCount * sizeof(Vertex));
     m_geometry.setDrawingMode(ShapeNode::drawingMode);
     m_geometry.setIndexDataPattern(ShapeNode::indexDataPattern);
     m_geometry.setVertexDataPattern(ShapeNode::vertexDataPattern);
@@ -82,15 +82,16 @@ const QSGGeometry::AttributeSet& ShapeOverlayNode::attributeSet()
 {
     static const QSGGeometry::Attribute attributes[] = {
         QSGGeometry::Attribute::create(0, 2, GL_FLOAT, true),
-        QSGGeometry::Attribute::create(1, 2, GL_FLOAT),
+        QSGGeometry::Attribute::create(1, 3, GL_FLOAT),
         QSGGeometry::Attribute::create(2, 4, GL_FLOAT),
-        QSGGeometry::Attribute::create(3, 1, GL_FLOAT),
+        QSGGeometry::Attribute::create(3, 4, GL_FLOAT),
         QSGGeometry::Attribute::create(4, 4, GL_UNSIGNED_BYTE),
-        QSGGeometry::Attribute::create(5, 2, GL_FLOAT),
-        QSGGeometry::Attribute::create(6, 4, GL_UNSIGNED_BYTE)
+        QSGGeometry::Attribute::create(5, 4, GL_UNSIGNED_BYTE),
+        QSGGeometry::Attribute::create(6, 2, GL_FLOAT),
+        QSGGeometry::Attribute::create(7, 4, GL_UNSIGNED_BYTE)
     };
     static const QSGGeometry::AttributeSet attributeSet = {
-        7, sizeof(Vertex), attributes
+        8, sizeof(Vertex), attributes
     };
     return attributeSet;
 }
@@ -225,10 +226,13 @@ static quint32 packColor(QRgb color)
 void UCUbuntuShapeOverlay::updateGeometry(
     QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
     const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-    const quint32 backgroundColor[3])
+    const QRectF& sourceRect, const quint32 backgroundColor[3], quint32 parameters)
 {
-    ShapeOverlayNode::Vertex* v = reinterpret_cast<ShapeOverlayNode::Vertex*>(
-        static_cast<ShapeOverlayNode*>(node)->geometry()->vertexData());
+    ShapeOverlayNode::Vertex v[ShapeNode::vertexCount];
+    const float sourceRectX = sourceRect.x();
+    const float sourceRectY = sourceRect.y();
+    const float sourceRectWidth = sourceRect.width();
+    const float sourceRectHeight = sourceRect.height();
 
     // Get the affine transformation for the overlay coordinates, pixels lying inside the mask
     // (values in the range [-1, 1]) will be considered overlaid in the fragment shader.
@@ -254,8 +258,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[0].sourceCoordinate[1] = sourceCoordTransform.w();
     v[0].sourceCoordinate[2] = sourceMaskTransform.z();
     v[0].sourceCoordinate[3] = sourceMaskTransform.w();
+    v[0].sourceRect[0] = sourceRectX;
+    v[0].sourceRect[1] = sourceRectY;
+    v[0].sourceRect[2] = sourceRectWidth;
+    v[0].sourceRect[3] = sourceRectHeight;
     v[0].yCoordinate = -1.0f;
     v[0].backgroundColor = backgroundColor[0];
+    v[0].parameters = parameters;
     v[0].overlayCoordinate[0] = overlayTx;
     v[0].overlayCoordinate[1] = overlayTy;
     v[0].overlayColor = overlayColor;
@@ -267,8 +276,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[1].sourceCoordinate[1] = sourceCoordTransform.w();
     v[1].sourceCoordinate[2] = 0.5f * sourceMaskTransform.x() + sourceMaskTransform.z();
     v[1].sourceCoordinate[3] = sourceMaskTransform.w();
+    v[1].sourceRect[0] = sourceRectX;
+    v[1].sourceRect[1] = sourceRectY;
+    v[1].sourceRect[2] = sourceRectWidth;
+    v[1].sourceRect[3] = sourceRectHeight;
     v[1].yCoordinate = -1.0f;
     v[1].backgroundColor = backgroundColor[0];
+    v[1].parameters = parameters;
     v[1].overlayCoordinate[0] = 0.5f * overlaySx + overlayTx;
     v[1].overlayCoordinate[1] = overlayTy;
     v[1].overlayColor = overlayColor;
@@ -280,8 +294,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[2].sourceCoordinate[1] = sourceCoordTransform.w();
     v[2].sourceCoordinate[2] = sourceMaskTransform.x() + sourceMaskTransform.z();
     v[2].sourceCoordinate[3] = sourceMaskTransform.w();
+    v[2].sourceRect[0] = sourceRectX;
+    v[2].sourceRect[1] = sourceRectY;
+    v[2].sourceRect[2] = sourceRectWidth;
+    v[2].sourceRect[3] = sourceRectHeight;
     v[2].yCoordinate = -1.0f;
     v[2].backgroundColor = backgroundColor[0];
+    v[2].parameters = parameters;
     v[2].overlayCoordinate[0] = overlaySx + overlayTx;
     v[2].overlayCoordinate[1] = overlayTy;
     v[2].overlayColor = overlayColor;
@@ -295,8 +314,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[3].sourceCoordinate[1] = 0.5f * sourceCoordTransform.y() + sourceCoordTransform.w();
     v[3].sourceCoordinate[2] = sourceMaskTransform.z();
     v[3].sourceCoordinate[3] = 0.5f * sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[3].sourceRect[0] = sourceRectX;
+    v[3].sourceRect[1] = sourceRectY;
+    v[3].sourceRect[2] = sourceRectWidth;
+    v[3].sourceRect[3] = sourceRectHeight;
     v[3].yCoordinate = 0.0f;
     v[3].backgroundColor = backgroundColor[1];
+    v[3].parameters = parameters;
     v[3].overlayCoordinate[0] = overlayTx;
     v[3].overlayCoordinate[1] = 0.5f * overlaySy + overlayTy;
     v[3].overlayColor = overlayColor;
@@ -308,8 +332,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[4].sourceCoordinate[1] = 0.5f * sourceCoordTransform.y() + sourceCoordTransform.w();
     v[4].sourceCoordinate[2] = 0.5f * sourceMaskTransform.x() + sourceMaskTransform.z();
     v[4].sourceCoordinate[3] = 0.5f * sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[4].sourceRect[0] = sourceRectX;
+    v[4].sourceRect[1] = sourceRectY;
+    v[4].sourceRect[2] = sourceRectWidth;
+    v[4].sourceRect[3] = sourceRectHeight;
     v[4].yCoordinate = 0.0f;
     v[4].backgroundColor = backgroundColor[1];
+    v[4].parameters = parameters;
     v[4].overlayCoordinate[0] = 0.5f * overlaySx + overlayTx;
     v[4].overlayCoordinate[1] = 0.5f * overlaySy + overlayTy;
     v[4].overlayColor = overlayColor;
@@ -321,8 +350,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[5].sourceCoordinate[1] = 0.5f * sourceCoordTransform.y() + sourceCoordTransform.w();
     v[5].sourceCoordinate[2] = sourceMaskTransform.x() + sourceMaskTransform.z();
     v[5].sourceCoordinate[3] = 0.5f * sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[5].sourceRect[0] = sourceRectX;
+    v[5].sourceRect[1] = sourceRectY;
+    v[5].sourceRect[2] = sourceRectWidth;
+    v[5].sourceRect[3] = sourceRectHeight;
     v[5].yCoordinate = 0.0f;
     v[5].backgroundColor = backgroundColor[1];
+    v[5].parameters = parameters;
     v[5].overlayCoordinate[0] = overlaySx + overlayTx;
     v[5].overlayCoordinate[1] = 0.5f * overlaySy + overlayTy;
     v[5].overlayColor = overlayColor;
@@ -336,8 +370,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[6].sourceCoordinate[1] = sourceCoordTransform.y() + sourceCoordTransform.w();
     v[6].sourceCoordinate[2] = sourceMaskTransform.z();
     v[6].sourceCoordinate[3] = sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[6].sourceRect[0] = sourceRectX;
+    v[6].sourceRect[1] = sourceRectY;
+    v[6].sourceRect[2] = sourceRectWidth;
+    v[6].sourceRect[3] = sourceRectHeight;
     v[6].yCoordinate = 1.0f;
     v[6].backgroundColor = backgroundColor[2];
+    v[6].parameters = parameters;
     v[6].overlayCoordinate[0] = overlayTx;
     v[6].overlayCoordinate[1] = overlaySy + overlayTy;
     v[6].overlayColor = overlayColor;
@@ -349,8 +388,13 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[7].sourceCoordinate[1] = sourceCoordTransform.y() + sourceCoordTransform.w();
     v[7].sourceCoordinate[2] = 0.5f * sourceMaskTransform.x() + sourceMaskTransform.z();
     v[7].sourceCoordinate[3] = sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[7].sourceRect[0] = sourceRectX;
+    v[7].sourceRect[1] = sourceRectY;
+    v[7].sourceRect[2] = sourceRectWidth;
+    v[7].sourceRect[3] = sourceRectHeight;
     v[7].yCoordinate = 1.0f;
     v[7].backgroundColor = backgroundColor[2];
+    v[7].parameters = parameters;
     v[7].overlayCoordinate[0] = 0.5f * overlaySx + overlayTx;
     v[7].overlayCoordinate[1] = overlaySy + overlayTy;
     v[7].overlayColor = overlayColor;
@@ -362,13 +406,19 @@ void UCUbuntuShapeOverlay::updateGeometry(
     v[8].sourceCoordinate[1] = sourceCoordTransform.y() + sourceCoordTransform.w();
     v[8].sourceCoordinate[2] = sourceMaskTransform.x() + sourceMaskTransform.z();
     v[8].sourceCoordinate[3] = sourceMaskTransform.y() + sourceMaskTransform.w();
+    v[8].sourceRect[0] = sourceRectX;
+    v[8].sourceRect[1] = sourceRectY;
+    v[8].sourceRect[2] = sourceRectWidth;
+    v[8].sourceRect[3] = sourceRectHeight;
     v[8].yCoordinate = 1.0f;
     v[8].backgroundColor = backgroundColor[2];
+    v[8].parameters = parameters;
     v[8].overlayCoordinate[0] = overlaySx + overlayTx;
     v[8].overlayCoordinate[1] = overlaySy + overlayTy;
     v[8].overlayColor = overlayColor;
 
-    node->markDirty(QSGNode::DirtyGeometry);
+    ShapeOverlayNode* overlayNode = static_cast<ShapeOverlayNode*>(node);
+    ShapeNode::updateVertices(overlayNode, overlayNode->geometry(), v);
 }
 
 UT_NAMESPACE_END
@@ -49,9 +49,11 @@ public:
     struct Vertex {
         float position[2];
         float shapeCoordinate[2];
-        float sourceCoordinate[4];
         float yCoordinate;
+        float sourceCoordinate[4];
+        float sourceRect[4];
         quint32 backgroundColor;
+        quint32 parameters;
         float overlayCoordinate[2];
         quint32 overlayColor;
     };
@@ -98,7 +100,7 @@ protected:
     void updateGeometry(
         QSGNode* node, const QSizeF& itemSize, float radius, float shapeOffset,
         const QVector4D& sourceCoordTransform, const QVector4D& sourceMaskTransform,
-        const quint32 backgroundColor[3]) override;
+        const QRectF& sourceRect, const quint32 backgroundColor[3], quint32 parameters) override;
 
 private:
     quint16 m_overlayX;
@@ -1,21 +1,47 @@
-// Copyright 2015 Canonical Ltd.
-// Automatically generated by the createshapetextures tool.
+/*
+ * Copyright 2015-2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Loïc Molinari <loic.molinari@canonical.com>
+ */
+
 #ifndef UCUBUNTUSHAPETEXTURES_H
 #define UCUBUNTUSHAPETEXTURES_H
 
+#include <UbuntuToolkit/ubuntutoolkitglobal.h>
+
+UT_NAMESPACE_BEGIN
+
 const int shapeTextureCount = 2;
 const int shapeTextureWidth = 32;
 const int shapeTextureHeight = 32;
 const float shapeTextureOffset = 0.0625;
 const int shapeTextureDistanceAA = 4;
 
-extern const unsigned char shapeTextureData[2][4097];
-
 const int shapeTextureMipmapWidth = 256;
 const int shapeTextureMipmapHeight = 256;
 const int shapeTextureMipmapCount = 9;
 
+// Offsets in bytes of the levels in the mipmap texture data.
 extern const int shapeTextureMipmapOffset[9];
-extern const unsigned char shapeTextureMipmapData[2][349525];
+
+// Get the RGBA data of the distance field textures and of the mipmap textures (all the levels).
+// Textures are generated at first use, or loaded from the disk cache, and kept for the lifetime of
+// the process. Thread-safe.
+UBUNTUTOOLKIT_EXPORT const quint8* shapeTextureData(int index);
+UBUNTUTOOLKIT_EXPORT const quint8* shapeTextureMipmapData(int index);
+
+UT_NAMESPACE_END
 
 #endif // UCUBUNTUSHAPETEXTURES_H
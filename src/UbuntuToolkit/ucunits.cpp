@@ -20,6 +20,7 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QtMath>
 #include <QtGui/QGuiApplication>
@@ -99,9 +100,16 @@ static float getenvFloat(const char* name, float defaultValue)
 
 UCUnits *UCUnits::m_units = nullptr;
 
+// Bounds of the resolution caches, keeping the number of watched directories
+// low for apps loading assets from many different directories.
+static const int maxResolvedResources = 1000;
+static const int maxDirectoryEntries = 64;
+
 UCUnits::UCUnits(QObject *parent) :
     QObject(parent),
-    m_devicePixelRatio(qGuiApp->devicePixelRatio())
+    m_devicePixelRatio(qGuiApp->devicePixelRatio()),
+    m_resolvedResources(maxResolvedResources),
+    m_directoryWatcher(nullptr)
 {
     // If GRID_UNIT_PX set, always use it. If not, 1GU := DEFAULT_GRID_UNIT_PX * m_devicePixelRatio
     if (qEnvironmentVariableIsSet(ENV_GRID_UNIT_PX)) {
@@ -138,6 +146,7 @@ void UCUnits::setGridUnit(float gridUnit)
         return;
     }
     m_gridUnit = gridUnit;
+    m_resolvedResources.clear();
     Q_EMIT gridUnitChanged();
 }
 
@@ -170,12 +179,29 @@ float UCUnits::gu(float value)
     return qRound(value * m_gridUnit) / m_devicePixelRatio;
 }
 
+/*
+ * Resolutions are cached until the grid unit changes or one of the directories
+ * they were resolved from changes, so that the many images sharing the same
+ * few assets don't each pay for the file system lookups. The least recently
+ * used resolutions are dropped past maxResolvedResources.
+ */
 QString UCUnits::resolveResource(const QUrl& url)
 {
     if (url.isEmpty()) {
         return QString();
     }
 
+    const QString *cached = m_resolvedResources.object(url);
+    if (cached) {
+        return *cached;
+    }
+    const QString resolved = resolveResourcePath(url);
+    m_resolvedResources.insert(url, new QString(resolved));
+    return resolved;
+}
+
+QString UCUnits::resolveResourcePath(const QUrl &url)
+{
     QString path = QQmlFile::urlToLocalFileOrQrc(url);
 
     if (path.isEmpty()) {
@@ -183,12 +209,11 @@ QString UCUnits::resolveResource(const QUrl& url)
     }
 
     const QFileInfo fileInfo(path);
-    if (fileInfo.exists()) {
-        if (fileInfo.isFile()) {
-            return QStringLiteral("1/") + path;
-        } else {
-            return QString();
-        }
+    const DirectoryEntries &entries = directoryEntries(fileInfo.dir());
+    if (entries.files.contains(fileInfo.fileName())) {
+        return QStringLiteral("1/") + path;
+    } else if (entries.directories.contains(fileInfo.fileName())) {
+        return QString();
     }
 
     const QString prefix = fileInfo.dir().absolutePath() + "/" + fileInfo.baseName();
@@ -198,9 +223,9 @@ QString UCUnits::resolveResource(const QUrl& url)
        For example, if m_gridUnit = 10, look for resource@10.png.
     */
 
-    path = prefix + suffixForGridUnit(m_gridUnit) + suffix;
-    if (QFile::exists(path)) {
-        return QStringLiteral("1/") + path;
+    const QString gridUnitFileName = fileInfo.baseName() + suffixForGridUnit(m_gridUnit) + suffix;
+    if (entries.files.contains(gridUnitFileName)) {
+        return QStringLiteral("1/") + prefix + suffixForGridUnit(m_gridUnit) + suffix;
     }
 
     /* No file with expected grid unit suffix exists.
@@ -219,9 +244,17 @@ QString UCUnits::resolveResource(const QUrl& url)
        file would be resource@14.png since it is above 10 and smaller
        than resource@18.png.
     */
-    QStringList nameFilters;
-    nameFilters << fileInfo.baseName() + "@[0-9]*" + suffix;
-    const QStringList files = fileInfo.dir().entryList(nameFilters, QDir::Files);
+    // Files matching the fileBaseName@[0-9]*.fileSuffix pattern.
+    const QString variantPrefix = fileInfo.baseName() + "@";
+    QStringList files;
+    Q_FOREACH (const QString& fileName, entries.files) {
+        if (fileName.size() > variantPrefix.size() + suffix.size()
+            && fileName.startsWith(variantPrefix) && fileName.endsWith(suffix)
+            && fileName.at(variantPrefix.size()).isDigit()) {
+            files.append(fileName);
+        }
+    }
+    files.sort();
 
     if (!files.empty()) {
         float selectedGridUnitSuffix = gridUnitSuffixFromFileName(files.first());
@@ -242,6 +275,49 @@ QString UCUnits::resolveResource(const QUrl& url)
     return QString();
 }
 
+const UCUnits::DirectoryEntries &UCUnits::directoryEntries(const QDir &dir)
+{
+    const QString path = dir.absolutePath();
+    QHash<QString, DirectoryEntries>::const_iterator it = m_directoryEntries.constFind(path);
+    if (it != m_directoryEntries.constEnd()) {
+        return it.value();
+    }
+
+    // Past maxDirectoryEntries, the indexed directories are all dropped and no
+    // longer watched, along with the resolutions that could then go stale.
+    if (m_directoryEntries.size() >= maxDirectoryEntries) {
+        m_directoryEntries.clear();
+        m_resolvedResources.clear();
+        if (m_directoryWatcher && !m_directoryWatcher->directories().isEmpty()) {
+            m_directoryWatcher->removePaths(m_directoryWatcher->directories());
+        }
+    }
+
+    DirectoryEntries entries;
+    entries.files = dir.entryList(QDir::Files | QDir::Hidden).toSet();
+    entries.directories =
+        dir.entryList(QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot).toSet();
+
+    // Resources can't change, other directories are watched so that assets
+    // added or removed at run-time are taken into account.
+    if (!path.startsWith(QLatin1Char(':')) && dir.exists()) {
+        if (!m_directoryWatcher) {
+            m_directoryWatcher = new QFileSystemWatcher(this);
+            QObject::connect(m_directoryWatcher, &QFileSystemWatcher::directoryChanged,
+                             this, &UCUnits::directoryChanged);
+        }
+        m_directoryWatcher->addPath(path);
+    }
+
+    return m_directoryEntries.insert(path, entries).value();
+}
+
+void UCUnits::directoryChanged(const QString &path)
+{
+    m_directoryEntries.remove(path);
+    m_resolvedResources.clear();
+}
+
 QString UCUnits::suffixForGridUnit(float gridUnit)
 {
     return "@" + QString::number(gridUnit);
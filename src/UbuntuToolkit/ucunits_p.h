@@ -19,13 +19,17 @@
 #ifndef UCUNITS_P_H
 #define UCUNITS_P_H
 
+#include <QtCore/QCache>
 #include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QUrl>
 
 #include <UbuntuToolkit/ubuntutoolkitglobal.h>
 
+class QDir;
+class QFileSystemWatcher;
 class QPlatformWindow;
 
 UT_NAMESPACE_BEGIN
@@ -68,11 +72,25 @@ protected:
 
 private Q_SLOTS:
     void windowPropertyChanged(QPlatformWindow *window, const QString &propertyName);
+    void directoryChanged(const QString &path);
 
 private:
+    struct DirectoryEntries {
+        QSet<QString> files;
+        QSet<QString> directories;
+    };
+
+    QString resolveResourcePath(const QUrl &url);
+    const DirectoryEntries &directoryEntries(const QDir &dir);
+
     static UCUnits *m_units;
     float m_devicePixelRatio;
     float m_gridUnit;
+    // Resolved resources for the current grid unit and the entries of the
+    // directories they were resolved from.
+    QCache<QUrl, QString> m_resolvedResources;
+    QHash<QString, DirectoryEntries> m_directoryEntries;
+    QFileSystemWatcher *m_directoryWatcher;
 };
 
 UT_NAMESPACE_END
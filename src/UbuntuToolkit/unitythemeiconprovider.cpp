@@ -18,8 +18,14 @@
 
 #include "unitythemeiconprovider_p.h"
 
+#include <QtCore/QCache>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutex>
+#include <QtCore/QSaveFile>
 #include <QtCore/QSettings>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QtDebug>
@@ -27,6 +33,14 @@
 
 UT_NAMESPACE_BEGIN
 
+// Header of the icon theme index cache files, the version must be bumped when
+// the format changes.
+static const quint32 indexCacheMagic = 0x55434954;  // "UCIT"
+static const quint32 indexCacheVersion = 1;
+
+// Maximum size in bytes of the decoded icons cache.
+static const int iconCacheMaxSize = 8 * 1024 * 1024;
+
 class IconTheme
 {
 public:
@@ -35,7 +49,10 @@ public:
     // Returns the icon theme named @name, creating it if it didn't exist yet.
     static IconThemePointer get(const QString &name)
     {
+        // Recursive since the constructor gets the parent themes.
+        static QMutex mutex(QMutex::Recursive);
         static QHash<QString, IconThemePointer> themes;
+        QMutexLocker locker(&mutex);
 
         IconThemePointer theme = themes[name];
         if (theme.isNull()) {
@@ -57,6 +74,8 @@ public:
             alreadySearchedThemes->insert(name);
         }
 
+        ensureIndex();
+
         Q_FOREACH(const QString &name, names) {
             QImage image = lookupIcon(name, impsize, size);
             if (!image.isNull())
@@ -81,7 +100,13 @@ private:
         int size, minSize, maxSize, threshold;
     };
 
-    IconTheme(const QString &name): name(name)
+    // Icon file found in one of the theme directories.
+    struct IconFile {
+        int directory;
+        QString filename;
+    };
+
+    IconTheme(const QString &name): name(name), indexed(false)
     {
         const QStringList paths = QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
 
@@ -124,6 +149,159 @@ private:
         }
     }
 
+    // Builds the index of the icon files of the theme, mapping icon names to
+    // the files found in each theme directory, so that lookups don't have to
+    // stat() every directory of every base dir. The index is loaded from a
+    // cache file if none of the scanned directories changed since it was
+    // written.
+    void ensureIndex()
+    {
+        QMutexLocker locker(&mutex);
+        if (indexed)
+            return;
+        indexed = true;
+
+        const QString cacheFile =
+            QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/ubuntu-ui-toolkit/icon-themes/" + cacheFileName();
+        const QVector<qint64> timeStamps = directoryTimeStamps();
+        if (!loadIndex(cacheFile, timeStamps)) {
+            scanDirectories();
+            saveIndex(cacheFile, timeStamps);
+        }
+    }
+
+    // Cache file name keyed on the toolkit version and the theme base dirs, so
+    // that different toolkit versions and XDG_DATA_DIRS setups sharing a cache
+    // directory don't keep overwriting each other's index.
+    QString cacheFileName() const
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(QByteArrayLiteral(UBUNTUTOOLKIT_VERSION_STRING));
+        Q_FOREACH(const QString &baseDir, baseDirs) {
+            hash.addData("\0", 1);
+            hash.addData(baseDir.toUtf8());
+        }
+        return name + "-" + QString::fromLatin1(hash.result().toHex().left(16)) + ".cache";
+    }
+
+    // Modification times of the theme directories in each base dir, -1 for
+    // the ones that don't exist. Adding or removing an icon changes the
+    // modification time of its directory, invalidating the cached index.
+    QVector<qint64> directoryTimeStamps()
+    {
+        QVector<qint64> timeStamps;
+        timeStamps.reserve(baseDirs.size() * directories.size());
+        Q_FOREACH(const QString &baseDir, baseDirs) {
+            Q_FOREACH(const Directory &dir, directories) {
+                QFileInfo info(baseDir + "/" + dir.path);
+                timeStamps.append(info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1);
+            }
+        }
+        return timeStamps;
+    }
+
+    void scanDirectories()
+    {
+        const QStringList pngFilter(QStringLiteral("*.png"));
+        const QStringList svgFilter(QStringLiteral("*.svg"));
+        const QDir::Filters filters = QDir::Files | QDir::CaseSensitive;
+
+        // Same precedence as a lookup of each file: the first base dir wins and
+        // PNG icons win over SVG ones in a given base dir.
+        for (int i = 0; i < directories.size(); ++i) {
+            QHash<QString, QString> files;
+            Q_FOREACH(const QString &baseDir, baseDirs) {
+                const QDir dir(baseDir + "/" + directories[i].path);
+                if (!dir.exists())
+                    continue;
+                Q_FOREACH(const QString &entry, dir.entryList(pngFilter, filters)
+                          + dir.entryList(svgFilter, filters)) {
+                    const QString iconName = entry.left(entry.size() - 4);
+                    if (!files.contains(iconName))
+                        files.insert(iconName, dir.path() + "/" + entry);
+                }
+            }
+            for (QHash<QString, QString>::const_iterator it = files.constBegin();
+                 it != files.constEnd(); ++it) {
+                IconFile file;
+                file.directory = i;
+                file.filename = it.value();
+                index[it.key()].append(file);
+            }
+        }
+    }
+
+    bool loadIndex(const QString &cacheFile, const QVector<qint64> &timeStamps)
+    {
+        QFile file(cacheFile);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_0);
+        quint32 magic, version;
+        QStringList cachedBaseDirs, cachedDirectories;
+        QVector<qint64> cachedTimeStamps;
+        stream >> magic >> version;
+        if (magic != indexCacheMagic || version != indexCacheVersion)
+            return false;
+        stream >> cachedBaseDirs >> cachedDirectories >> cachedTimeStamps;
+        QStringList directoryPaths;
+        Q_FOREACH(const Directory &dir, directories) {
+            directoryPaths.append(dir.path);
+        }
+        if (stream.status() != QDataStream::Ok || cachedBaseDirs != baseDirs
+            || cachedDirectories != directoryPaths || cachedTimeStamps != timeStamps)
+            return false;
+
+        qint32 iconCount;
+        stream >> iconCount;
+        for (qint32 i = 0; i < iconCount && stream.status() == QDataStream::Ok; ++i) {
+            QString iconName;
+            qint32 fileCount;
+            stream >> iconName >> fileCount;
+            QVector<IconFile> &files = index[iconName];
+            for (qint32 j = 0; j < fileCount && stream.status() == QDataStream::Ok; ++j) {
+                IconFile file;
+                stream >> file.directory >> file.filename;
+                if (file.directory < 0 || file.directory >= directories.size())
+                    stream.setStatus(QDataStream::ReadCorruptData);
+                files.append(file);
+            }
+        }
+        if (stream.status() != QDataStream::Ok) {
+            index.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void saveIndex(const QString &cacheFile, const QVector<qint64> &timeStamps)
+    {
+        QDir().mkpath(QFileInfo(cacheFile).path());
+        QSaveFile file(cacheFile);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_0);
+        QStringList directoryPaths;
+        Q_FOREACH(const Directory &dir, directories) {
+            directoryPaths.append(dir.path);
+        }
+        stream << indexCacheMagic << indexCacheVersion << baseDirs << directoryPaths
+               << timeStamps << static_cast<qint32>(index.size());
+        for (QHash<QString, QVector<IconFile> >::const_iterator it = index.constBegin();
+             it != index.constEnd(); ++it) {
+            stream << it.key() << static_cast<qint32>(it.value().size());
+            Q_FOREACH(const IconFile &iconFile, it.value()) {
+                stream << static_cast<qint32>(iconFile.directory) << iconFile.filename;
+            }
+        }
+        file.commit();
+    }
+
     SizeType sizeTypeFromString(const QString &string)
     {
         if (string == QLatin1String("Fixed"))
@@ -136,7 +314,34 @@ private:
         return Fixed;
     }
 
+    // Decoded icons are shared by all the themes in a LRU cache keyed by file
+    // name and requested size.
     static QImage loadIcon(const QString &filename, QSize *impsize, const QSize &requestSize)
+    {
+        static QMutex cacheMutex;
+        static QCache<QString, QImage> cache(iconCacheMaxSize);
+        const QString key = QStringLiteral("%1@%2x%3").arg(filename).arg(requestSize.width())
+            .arg(requestSize.height());
+
+        cacheMutex.lock();
+        if (QImage *cachedImage = cache.object(key)) {
+            const QImage image = *cachedImage;
+            cacheMutex.unlock();
+            if (impsize)
+                *impsize = image.size();
+            return image;
+        }
+        cacheMutex.unlock();
+
+        const QImage image = decodeIcon(filename, impsize, requestSize);
+        if (!image.isNull()) {
+            QMutexLocker locker(&cacheMutex);
+            cache.insert(key, new QImage(image), image.byteCount());
+        }
+        return image;
+    }
+
+    static QImage decodeIcon(const QString &filename, QSize *impsize, const QSize &requestSize)
     {
         QImageReader imgio(filename);
 
@@ -173,24 +378,6 @@ private:
         }
     }
 
-    QString lookupIconFile(const QString &dir, const QString &name)
-    {
-        QString png = QStringLiteral("%1/%2.png").arg(dir, name);
-        QString svg = QStringLiteral("%1/%2.svg").arg(dir, name);
-
-        Q_FOREACH(const QString &baseDir, baseDirs) {
-            QString filename = baseDir + "/" + png;
-            if (QFileInfo::exists(filename))
-                return filename;
-
-            filename = baseDir + "/" + svg;
-            if (QFileInfo::exists(filename))
-                return filename;
-        }
-
-        return QString();
-    }
-
     QImage lookupIcon(const QString &iconName, QSize *impsize, const QSize &size)
     {
         const int iconSize = qMax(size.width(), size.height());
@@ -205,20 +392,19 @@ private:
         int minDistance = 10000;
         QString bestFilename;
 
-        Q_FOREACH(const Directory &dir, directories) {
-            int dist = directorySizeDistance(dir, size);
+        // Files are indexed in the order of the theme directories.
+        const QVector<IconFile> files = index.value(iconName);
+        Q_FOREACH(const IconFile &file, files) {
+            int dist = directorySizeDistance(directories[file.directory], size);
             if (dist >= minDistance)
                 continue;
 
-            QString filename = lookupIconFile(dir.path, iconName);
-            if (!filename.isNull()) {
-                minDistance = dist;
-                bestFilename = filename;
+            minDistance = dist;
+            bestFilename = file.filename;
 
-                // bail out early if we can't get a better size match
-                if (minDistance == 0)
-                    break;
-            }
+            // bail out early if we can't get a better size match
+            if (minDistance == 0)
+                break;
         }
 
         if (!bestFilename.isNull())
@@ -232,16 +418,15 @@ private:
         int maxSize = 0;
         QString bestFilename;
 
-        Q_FOREACH(const Directory &dir, directories) {
+        const QVector<IconFile> files = index.value(iconName);
+        Q_FOREACH(const IconFile &file, files) {
+            const Directory &dir = directories[file.directory];
             int size = dir.sizeType == Scalable ? dir.maxSize : dir.size;
             if (size < maxSize)
                 continue;
 
-            QString filename = lookupIconFile(dir.path, iconName);
-            if (!filename.isNull()) {
-                maxSize = size;
-                bestFilename = filename;
-            }
+            maxSize = size;
+            bestFilename = file.filename;
         }
 
         if (!bestFilename.isNull())
@@ -272,6 +457,9 @@ private:
     QStringList baseDirs;
     QList<Directory> directories;
     QList<IconThemePointer> parents;
+    QHash<QString, QVector<IconFile> > index;
+    bool indexed;
+    QMutex mutex;
 };
 
 UnityThemeIconProvider::UnityThemeIconProvider(const QString &themeName):
@@ -28,14 +28,15 @@ class QSocketNotifier;
 
 UT_NAMESPACE_BEGIN
 
-class UnixSignalHandler : public QObject
+class UBUNTUTOOLKIT_EXPORT UnixSignalHandler : public QObject
 {
     Q_OBJECT
 public:
     enum SignalType {
         Invalid = 0,
         Interrupt = SIGINT,
-        Terminate = SIGTERM
+        Terminate = SIGTERM,
+        User2 = SIGUSR2
     };
 
     typedef QPair<std::array<int, 2>, QSocketNotifier*> HandlerType;
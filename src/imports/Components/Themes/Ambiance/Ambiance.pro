@@ -124,5 +124,6 @@ QML_FILES += 1.2/ActivityIndicatorStyle.qml \
              $$ARTWORK_FILES
 
 load(ubuntu_qml_module)
+load(ubuntu_theme_bundle)
 
 OTHER_FILES+=qmldir
@@ -16,3 +16,4 @@ QML_FILES += 1.2/MainViewStyle.qml \
              $$PARENT_THEME_FILE
 
 load(ubuntu_qml_module)
+load(ubuntu_theme_bundle)
@@ -15,3 +15,4 @@ QML_FILES += MainViewStyle.qml \
     $$DEPRECATED_FILE
 
 load(ubuntu_qml_module)
+load(ubuntu_theme_bundle)
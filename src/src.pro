@@ -23,6 +23,13 @@ linux {
     SUBDIRS += src_metrics_lttng_plugin
 }
 
+# Tools
+
+src_metrics_tracedecoder.subdir = UbuntuMetrics/tools/tracedecoder
+src_metrics_tracedecoder.target = sub-metrics-tracedecoder
+src_metrics_tracedecoder.depends = sub-metrics-lib
+SUBDIRS += src_metrics_tracedecoder
+
 # QML modules
 
 src_metrics_module.subdir = imports/Metrics
@@ -0,0 +1,3 @@
+include(../test-include-x11.pri)
+SOURCES += tst_drawcall_benchmark.cpp
+DEFINES += PERFORMANCE_SOURCE_DIR=\\\"$$PWD/../performance/\\\"
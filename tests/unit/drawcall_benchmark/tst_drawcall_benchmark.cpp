@@ -0,0 +1,166 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtCore/QMutex>
+#include <QtGui/QGuiApplication>
+#include <QtQml/QQmlEngine>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QQuickView>
+#include <QtTest/QtTest>
+
+/*
+ * Counts the draw calls issued by the QtQuick scene graph renderer to render
+ * a frame of the performance test documents and fails if it's higher than the
+ * expected maximum. The count is retrieved from the batch renderer debug output
+ * (QSG_RENDERER_DEBUG=render), a merged batch is rendered with one draw call
+ * and an unmerged batch with one draw call per node.
+ */
+
+static QMutex drawCallMutex;
+static int drawCallCount = 0;
+static bool frameParsed = false;
+static QtMessageHandler previousMessageHandler = 0;
+
+static void drawCallMessageHandler(
+    QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    if (type == QtDebugMsg) {
+        if (message.startsWith(QStringLiteral("Rendering:"))) {
+            // Start of the batches of a new frame.
+            QMutexLocker locker(&drawCallMutex);
+            drawCallCount = 0;
+            frameParsed = true;
+            return;
+        }
+        if (message.contains(QStringLiteral("[  merged]"))) {
+            QMutexLocker locker(&drawCallMutex);
+            drawCallCount++;
+            return;
+        }
+        if (message.contains(QStringLiteral("[unmerged]"))) {
+            const int index = message.indexOf(QStringLiteral("Nodes:"));
+            const int nodes = message.mid(index + 6).trimmed().section(' ', 0, 0).toInt();
+            QMutexLocker locker(&drawCallMutex);
+            drawCallCount += qMax(nodes, 1);
+            return;
+        }
+        if (message.startsWith(QStringLiteral(" -"))) {
+            // Other renderer debug output.
+            return;
+        }
+    }
+    previousMessageHandler(type, context, message);
+}
+
+class tst_DrawCallBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    QQuickView *m_quickView;
+
+    // Returns the draw calls of a new frame, -1 if it wasn't rendered or if the
+    // renderer debug output wasn't parsed.
+    int renderFrame()
+    {
+        {
+            QMutexLocker locker(&drawCallMutex);
+            frameParsed = false;
+        }
+        QSignalSpy frameSwappedSpy(m_quickView, SIGNAL(frameSwapped()));
+        // Move the root item back and forth to get a new frame rendered.
+        QQuickItem *root = m_quickView->rootObject();
+        root->setX(1.0 - root->x());
+        if (!frameSwappedSpy.wait(5000)) {
+            return -1;
+        }
+        QMutexLocker locker(&drawCallMutex);
+        return frameParsed ? drawCallCount : -1;
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        previousMessageHandler = qInstallMessageHandler(drawCallMessageHandler);
+
+        QString modules(UBUNTU_QML_IMPORT_PATH);
+        QVERIFY(QDir(modules).exists());
+        m_quickView = new QQuickView;
+        m_quickView->setGeometry(0, 0, 800, 600);
+        QQmlEngine *engine = m_quickView->engine();
+        QStringList imports = engine->importPathList();
+        imports.prepend(QDir(modules).absolutePath());
+        engine->setImportPathList(imports);
+        m_quickView->show();
+        QVERIFY(QTest::qWaitForWindowExposed(m_quickView));
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_quickView;
+        qInstallMessageHandler(previousMessageHandler);
+    }
+
+    void benchmark_drawCalls_data()
+    {
+        QTest::addColumn<QString>("document");
+        QTest::addColumn<int>("maxDrawCalls");
+
+        // The shapes are batched as long as they share the same source and shape textures, the
+        // drop shadow aspect using a dedicated shape texture.
+        QTest::newRow("grid with UbuntuShape") << "UbuntuShapeGrid.qml" << 2;
+        QTest::newRow("grid with UbuntuShapePair") << "PairOfUbuntuShapeGrid.qml" << 2;
+        QTest::newRow("grid with varied UbuntuShape") << "UbuntuShapeVariedGrid.qml" << 4;
+    }
+
+    void benchmark_drawCalls()
+    {
+        QFETCH(QString, document);
+        QFETCH(int, maxDrawCalls);
+
+        m_quickView->setSource(QUrl::fromLocalFile(QString(PERFORMANCE_SOURCE_DIR) + document));
+        QVERIFY(m_quickView->rootObject());
+
+        // Skip the first frame (uploads, shader compilation, etc).
+        QVERIFY2(renderFrame() >= 0, "No renderer debug output, draw calls can't be counted");
+        const int drawCalls = renderFrame();
+        QVERIFY2(drawCalls >= 0, "No renderer debug output, draw calls can't be counted");
+        QVERIFY2(drawCalls > 0, "No draw calls parsed from the renderer debug output");
+        QTest::setBenchmarkResult(drawCalls, QTest::Events);
+        m_quickView->setSource(QUrl());
+
+        QVERIFY2(drawCalls <= maxDrawCalls,
+                 qPrintable(QString("%1 draw calls, expected at most %2")
+                            .arg(drawCalls).arg(maxDrawCalls)));
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    // The renderer debug output is enabled when the scene graph is initialized,
+    // rendering on the GUI thread makes the frames easy to delimit.
+    qputenv("QSG_RENDERER_DEBUG", "render");
+    if (!qEnvironmentVariableIsSet("QSG_RENDER_LOOP")) {
+        qputenv("QSG_RENDER_LOOP", "basic");
+    }
+
+    QGuiApplication application(argc, argv);
+    tst_DrawCallBenchmark test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_drawcall_benchmark.moc"
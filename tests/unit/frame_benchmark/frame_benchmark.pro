@@ -0,0 +1,4 @@
+include(../test-include-x11.pri)
+QT += UbuntuMetrics UbuntuMetrics-private
+SOURCES += tst_frame_benchmark.cpp
+DEFINES += PERFORMANCE_SOURCE_DIR=\\\"$$PWD/../performance/\\\"
@@ -0,0 +1,359 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtGui/QGuiApplication>
+#include <QtQml/QQmlEngine>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QQuickView>
+#include <QtTest/QtTest>
+#include <UbuntuMetrics/applicationmonitor.h>
+#include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/logger.h>
+#include <UbuntuMetrics/private/histogram_p.h>
+
+/*
+ * Renders the documents of the performance test for a number of frames in a
+ * window monitored by UbuntuMetrics, scrolling their first Flickable (or
+ * rotating them if they don't have any), and writes the creation times and the
+ * frame time percentiles (in microseconds) to a JSON report. Software OpenGL
+ * and the basic render loop are used by default so that the numbers can be
+ * compared between machines without GPU.
+ *
+ * Environment variables:
+ *   UITK_FRAME_BENCHMARK_FRAMES: number of frames rendered per document
+ *       (default 60).
+ *   UITK_FRAME_BENCHMARK_OUTPUT: path of the JSON report (default
+ *       frame_benchmark.json in the current directory).
+ *   UITK_FRAME_BENCHMARK_BASELINE: path of the JSON report of a previous run,
+ *       a document fails if its total frame time p90 or its creation time is
+ *       higher than the baseline by more than UITK_FRAME_BENCHMARK_TOLERANCE
+ *       percent (default 25).
+ */
+
+// Collects the frame events logged by the application monitor.
+class FrameCollector : public UMLogger
+{
+public:
+    void log(const UMEvent &event) override
+    {
+        if (event.type == UMEvent::Frame) {
+            QMutexLocker locker(&m_mutex);
+            m_frames.append(event.frame);
+        }
+    }
+
+    bool isOpen() override
+    {
+        return true;
+    }
+
+    int count()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_frames.size();
+    }
+
+    QVector<UMFrameEvent> takeFrames()
+    {
+        QMutexLocker locker(&m_mutex);
+        QVector<UMFrameEvent> frames;
+        frames.swap(m_frames);
+        return frames;
+    }
+
+private:
+    QMutex m_mutex;
+    QVector<UMFrameEvent> m_frames;
+};
+
+class tst_FrameBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_FrameBenchmark()
+        : m_quickView(0)
+        , m_collector(0)
+        , m_frameCount(60)
+        , m_tolerance(25.0)
+    {
+    }
+
+private:
+    enum Metric { Total, Gui, Polish, Sync, Render, Gpu, Delta, MetricCount };
+
+    QQuickView *m_quickView;
+    FrameCollector *m_collector;
+    int m_frameCount;
+    double m_tolerance;
+    QJsonArray m_results;
+    QHash<QString, QJsonObject> m_baseline;
+
+    QQuickItem *findFlickable(QQuickItem *item)
+    {
+        if (item->inherits("QQuickFlickable")) {
+            return item;
+        }
+        Q_FOREACH(QQuickItem *child, item->childItems()) {
+            if (QQuickItem *flickable = findFlickable(child)) {
+                return flickable;
+            }
+        }
+        return 0;
+    }
+
+    // Renders count frames, scrolling the flickable back and forth at a
+    // constant speed or rotating the root item.
+    bool renderFrames(QQuickItem *root, int count)
+    {
+        const qreal scrollSpeed = 20.0;  // In pixels per frame.
+        QQuickItem *flickable = findFlickable(root);
+        const qreal range = flickable ?
+            flickable->property("contentHeight").toReal() - flickable->height() : 0.0;
+        const qreal origin = flickable ? flickable->property("originY").toReal() : 0.0;
+
+        QSignalSpy frameSwappedSpy(m_quickView, SIGNAL(frameSwapped()));
+        for (int i = 0; i < count; ++i) {
+            if (range > 0.0) {
+                qreal position = std::fmod(i * scrollSpeed, 2.0 * range);
+                if (position > range) {
+                    position = 2.0 * range - position;
+                }
+                flickable->setProperty("contentY", origin + position);
+            } else {
+                root->setRotation((i * 6) % 360);
+            }
+            m_quickView->update();
+            if (!frameSwappedSpy.wait(5000)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static QJsonObject percentiles(const Histogram &histogram)
+    {
+        QJsonObject object;
+        object.insert("p50", static_cast<double>(histogram.percentile(50.0f)));
+        object.insert("p90", static_cast<double>(histogram.percentile(90.0f)));
+        object.insert("p99", static_cast<double>(histogram.percentile(99.0f)));
+        object.insert("max", static_cast<double>(histogram.max()));
+        return object;
+    }
+
+    void compareToBaseline(const QJsonObject &result)
+    {
+        const QString document = result.value("document").toString();
+        if (!m_baseline.contains(document)) {
+            return;
+        }
+        const QJsonObject baseline = m_baseline.value(document);
+        const double factor = 1.0 + m_tolerance / 100.0;
+
+        const double frameTime =
+            result.value("frameTime").toObject().value("total").toObject().value("p90").toDouble();
+        const double baselineFrameTime =
+            baseline.value("frameTime").toObject().value("total").toObject().value("p90").toDouble();
+        if (baselineFrameTime > 0.0 && frameTime > baselineFrameTime * factor) {
+            QFAIL(qPrintable(QString("Total frame time p90 regressed from %1 us to %2 us")
+                             .arg(baselineFrameTime).arg(frameTime)));
+        }
+
+        const double creationTime = result.value("creationTime").toDouble();
+        const double baselineCreationTime = baseline.value("creationTime").toDouble();
+        if (baselineCreationTime > 0.0 && creationTime > baselineCreationTime * factor) {
+            QFAIL(qPrintable(QString("Creation time regressed from %1 us to %2 us")
+                             .arg(baselineCreationTime).arg(creationTime)));
+        }
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        bool ok;
+        const int frameCount = qgetenv("UITK_FRAME_BENCHMARK_FRAMES").toInt(&ok);
+        if (ok && frameCount > 0) {
+            m_frameCount = frameCount;
+        }
+        const double tolerance = qgetenv("UITK_FRAME_BENCHMARK_TOLERANCE").toDouble(&ok);
+        if (ok && tolerance >= 0.0) {
+            m_tolerance = tolerance;
+        }
+
+        const QString baselinePath = QString::fromLocal8Bit(qgetenv("UITK_FRAME_BENCHMARK_BASELINE"));
+        if (!baselinePath.isEmpty()) {
+            QFile baselineFile(baselinePath);
+            QVERIFY2(baselineFile.open(QIODevice::ReadOnly), qPrintable(baselinePath));
+            const QJsonArray results =
+                QJsonDocument::fromJson(baselineFile.readAll()).object().value("results").toArray();
+            Q_FOREACH(const QJsonValue &value, results) {
+                const QJsonObject result = value.toObject();
+                m_baseline.insert(result.value("document").toString(), result);
+            }
+        }
+
+        // The logging must be enabled before the window is shown to be
+        // monitored.
+        UMApplicationMonitor *monitor = UMApplicationMonitor::instance();
+        m_collector = new FrameCollector;
+        QVERIFY(monitor->installLogger(m_collector));
+        monitor->setLoggingFilter(UMApplicationMonitor::FrameEvent);
+        monitor->setLogging(true);
+
+        QString modules(UBUNTU_QML_IMPORT_PATH);
+        QVERIFY(QDir(modules).exists());
+        m_quickView = new QQuickView;
+        m_quickView->setGeometry(0, 0, 240, 320);
+        QQmlEngine *engine = m_quickView->engine();
+        QStringList imports = engine->importPathList();
+        imports.prepend(QDir(modules).absolutePath());
+        engine->setImportPathList(imports);
+        m_quickView->show();
+        QVERIFY(QTest::qWaitForWindowExposed(m_quickView));
+    }
+
+    void cleanupTestCase()
+    {
+        UMApplicationMonitor *monitor = UMApplicationMonitor::instance();
+        monitor->setLogging(false);
+        monitor->clearLoggers();
+        m_collector = 0;
+        delete m_quickView;
+
+        QJsonObject report;
+        report.insert("qtVersion", QString(qVersion()));
+        report.insert("renderLoop", QString::fromLocal8Bit(qgetenv("QSG_RENDER_LOOP")));
+        report.insert("frames", m_frameCount);
+        report.insert("results", m_results);
+        QString outputPath = QString::fromLocal8Bit(qgetenv("UITK_FRAME_BENCHMARK_OUTPUT"));
+        if (outputPath.isEmpty()) {
+            outputPath = "frame_benchmark.json";
+        }
+        QFile output(outputPath);
+        QVERIFY2(output.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(outputPath));
+        output.write(QJsonDocument(report).toJson());
+    }
+
+    void benchmark_frames_data()
+    {
+        QTest::addColumn<QString>("document");
+
+        QTest::newRow("grid with Rectangle") << "RectangleGrid.qml";
+        QTest::newRow("grid with Text") << "TextGrid.qml";
+        QTest::newRow("grid with Label 1.3") << "LabelGrid13.qml";
+        QTest::newRow("grid with UbuntuShape") << "UbuntuShapeGrid.qml";
+        QTest::newRow("grid with UbuntuShapePair") << "PairOfUbuntuShapeGrid.qml";
+        QTest::newRow("grid with varied UbuntuShape") << "UbuntuShapeVariedGrid.qml";
+        QTest::newRow("grid with Button") << "ButtonGrid.qml";
+        QTest::newRow("grid with Slider") << "SliderGrid.qml";
+        QTest::newRow("grid with Switch") << "SwitchGrid.qml";
+        QTest::newRow("grid with CheckBox") << "CheckBoxGrid.qml";
+        QTest::newRow("grid with AbstractButton 1.3") << "AbstractButton13Grid.qml";
+        QTest::newRow("grid with TextArea 1.3") << "TextArea13Grid.qml";
+        QTest::newRow("list with QtQuick Item") << "ItemList.qml";
+        QTest::newRow("list with new ListItem 1.3") << "ListItemList13.qml";
+        QTest::newRow("list with new ListItem with actions") << "ListItemWithActionsList.qml";
+        QTest::newRow("list with new ListItem with inline actions") << "ListItemWithInlineActionsList.qml";
+        QTest::newRow("list with Captions 1.3") << "ListOfCaptions13.qml";
+        QTest::newRow("list with empty ListItemLayout") << "ListOfEmptyListItemLayout.qml";
+        QTest::newRow("list with ListItemLayout with 2 labels") << "ListOfListItemLayout_labelsOnly.qml";
+        QTest::newRow("list with ListItemLayout with 2 labels and 3 slots") << "ListOfListItemLayout_complex1.qml";
+        QTest::newRow("list with ListItemLayout with 3 labels and 3 slots") << "ListOfListItemLayout_complex2.qml";
+        QTest::newRow("list with custom layouts") << "ListOfCustomListItemLayouts.qml";
+        QTest::newRow("list of Scrollbar 1.3") << "ListOfScrollbars_1_3.qml";
+        QTest::newRow("list of ScrollView 1.3") << "ListOfScrollView_bothScrollbars_1_3.qml";
+        QTest::newRow("single MainView") << "MainView.qml";
+    }
+
+    void benchmark_frames()
+    {
+        QFETCH(QString, document);
+
+        QElapsedTimer timer;
+        timer.start();
+        m_quickView->setSource(QUrl::fromLocalFile(QString(PERFORMANCE_SOURCE_DIR) + document));
+        const qint64 creationTime = timer.nsecsElapsed();
+        QQuickItem *root = m_quickView->rootObject();
+        QVERIFY(root);
+
+        // Skip the first frames (shader compilation, texture uploads, etc).
+        QVERIFY(renderFrames(root, 5));
+        QTest::qWait(50);
+        m_collector->takeFrames();
+
+        // GPU times being retrieved a few frames later, a few more frames are
+        // rendered so that all the measured frames get logged.
+        QVERIFY(renderFrames(root, m_frameCount + 8));
+        QTRY_VERIFY(m_collector->count() >= m_frameCount);
+        const QVector<UMFrameEvent> frames = m_collector->takeFrames().mid(0, m_frameCount);
+
+        Histogram histograms[MetricCount];
+        Q_FOREACH(const UMFrameEvent &frame, frames) {
+            const quint64 times[MetricCount] = {
+                frame.guiTime + frame.syncTime + frame.renderTime + frame.swapTime,
+                frame.guiTime, frame.polishTime, frame.syncTime, frame.renderTime,
+                frame.gpuTime, frame.deltaTime
+            };
+            for (int i = 0; i < MetricCount; ++i) {
+                histograms[i].record(qMin(times[i] / 1000, 0xffffffffull));
+            }
+        }
+
+        const char *const metricNames[MetricCount] = {
+            "total", "gui", "polish", "sync", "render", "gpu", "delta"
+        };
+        QJsonObject frameTime;
+        for (int i = 0; i < MetricCount; ++i) {
+            frameTime.insert(metricNames[i], percentiles(histograms[i]));
+        }
+        QJsonObject result;
+        result.insert("document", document);
+        result.insert("creationTime", static_cast<double>(creationTime / 1000));
+        result.insert("frameCount", frames.size());
+        result.insert("frameTime", frameTime);
+        m_results.append(result);
+
+        m_quickView->setSource(QUrl());
+        compareToBaseline(result);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    // Software OpenGL and the basic render loop give reproducible numbers on
+    // machines without GPU, it can still be overridden by the environment.
+    if (!qEnvironmentVariableIsSet("LIBGL_ALWAYS_SOFTWARE")) {
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+    }
+    if (!qEnvironmentVariableIsSet("QSG_RENDER_LOOP")) {
+        qputenv("QSG_RENDER_LOOP", "basic");
+    }
+
+    QGuiApplication application(argc, argv);
+    tst_FrameBenchmark test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_frame_benchmark.moc"
@@ -32,6 +32,8 @@ private Q_SLOTS:
     void initTestCase()
     {
         qputenv("XDG_DATA_DIRS", SRCDIR);
+        // Index caches are written to a test cache location.
+        QStandardPaths::setTestModeEnabled(true);
     }
 
     void test_loadIcon_data()
@@ -93,6 +95,23 @@ private Q_SLOTS:
         QVERIFY(!i.isNull());
         QCOMPARE(QColor(i.pixel(0,0)), QColor(Qt::black));
     }
+
+    void test_indexCache()
+    {
+        QSize returnedSize;
+        UnityThemeIconProvider provider("mockTheme");
+        QVERIFY(!provider.requestImage("gallery-app", &returnedSize, QSize(-1, -1)).isNull());
+
+        // The theme index has been cached for the next launches.
+        const QString cacheDir =
+            QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/ubuntu-ui-toolkit/icon-themes/";
+        // The cache file name is keyed on the toolkit version and the theme
+        // base dirs, not only on the theme name.
+        const QStringList cacheFiles =
+            QDir(cacheDir).entryList(QStringList("mockTheme-*.cache"), QDir::Files);
+        QVERIFY(!cacheFiles.isEmpty());
+    }
 };
 
 QTEST_MAIN(tst_IconProvider)
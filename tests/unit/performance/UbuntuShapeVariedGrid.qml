@@ -0,0 +1,37 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.4
+import Ubuntu.Components 1.3
+
+// Grid of UbuntuShapes with different aspects, radii and colors.
+Grid {
+    width: 800
+    height: 600
+    rows: 16
+    columns: 16
+    spacing: 2
+    Repeater {
+        model: 16*16
+        UbuntuShape {
+            width: 48
+            height: 35
+            aspect: [UbuntuShape.Flat, UbuntuShape.Inset, UbuntuShape.DropShadow][index % 3]
+            relativeRadius: 0.05 + (index % 8) * 0.03
+            backgroundColor: Qt.rgba((index % 16) / 16, 0.5, 1.0 - (index % 16) / 16, 1.0)
+        }
+    }
+}
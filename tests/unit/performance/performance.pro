@@ -4,6 +4,7 @@ DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 OTHER_FILES += \
     UbuntuShapeGrid.qml \
+    UbuntuShapeVariedGrid.qml \
     ButtonStyleGrid.qml \
     PairOfUbuntuShapeGrid.qml \
     ButtonGrid.qml \
@@ -0,0 +1,5 @@
+include(../test-include-x11.pri)
+QT += gui
+
+SOURCES += \
+    tst_programbinarycache.cpp
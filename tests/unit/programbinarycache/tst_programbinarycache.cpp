@@ -0,0 +1,82 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtTest/QtTest>
+#include <UbuntuToolkit/private/programbinarycache_p.h>
+
+UT_USE_NAMESPACE
+
+class tst_ProgramBinaryCache : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+    void initTestCase()
+    {
+        // Keep the binaries out of the user's cache directory.
+        QStandardPaths::setTestModeEnabled(true);
+        QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+             + "/ubuntu-ui-toolkit/programs").removeRecursively();
+    }
+
+    void hitRate()
+    {
+        QOffscreenSurface surface;
+        surface.create();
+        QOpenGLContext context;
+        if (!context.create() || !context.makeCurrent(&surface)) {
+            QSKIP("Requires working OpenGL");
+        }
+
+        static const char vertexSource[] =
+            "attribute highp vec4 positionAttrib;\n"
+            "void main() { gl_Position = positionAttrib; }\n";
+        static const char fragmentSource[] =
+            "void main() { gl_FragColor = vec4(1.0); }\n";
+        static char const* const attributeNames[] = { "positionAttrib", 0 };
+
+        // The first link compiles the sources and stores the binary, the next ones use it.
+        const int hits = ProgramBinaryCache::hitCount();
+        const int misses = ProgramBinaryCache::missCount();
+        {
+            QOpenGLShaderProgram program;
+            QVERIFY(ProgramBinaryCache::link(
+                &program, vertexSource, fragmentSource, attributeNames));
+        }
+        if (ProgramBinaryCache::missCount() == misses) {
+            QSKIP("Program binaries not supported");
+        }
+        QCOMPARE(ProgramBinaryCache::missCount(), misses + 1);
+        for (int i = 0; i < 3; i++) {
+            QOpenGLShaderProgram program;
+            QVERIFY(ProgramBinaryCache::link(
+                &program, vertexSource, fragmentSource, attributeNames));
+            QVERIFY(program.isLinked());
+        }
+        QCOMPARE(ProgramBinaryCache::hitCount(), hits + 3);
+        QCOMPARE(ProgramBinaryCache::missCount(), misses + 1);
+    }
+#endif
+};
+
+QTEST_MAIN(tst_ProgramBinaryCache)
+
+#include "tst_programbinarycache.moc"
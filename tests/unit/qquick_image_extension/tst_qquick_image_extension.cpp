@@ -21,8 +21,11 @@
 #include <QtTest/QtTest>
 #include <UbuntuToolkit/ubuntutoolkitmodule.h>
 #define protected public
+#define private public
 #include <UbuntuToolkit/private/ucqquickimageextension_p.h>
+#undef private
 #undef protected
+#include <UbuntuToolkit/private/ucunits_p.h>
 
 UT_USE_NAMESPACE
 
@@ -99,8 +102,8 @@ private Q_SLOTS:
 
     void cachingOfRewrittenSciFiles() {
         /* This tests an internal implementation detail of UCQQuickImageExtension,
-           namely making sure that only one temporary rewritten .sci file is
-           created for each source .sci file.
+           namely making sure that rewritten .sci files are served from memory,
+           only once for each source .sci file and scale factor.
         */
         QQuickImageBase baseImage;
         UCQQuickImageExtension* image1 = new UCQQuickImageExtension(&baseImage);
@@ -108,21 +111,43 @@ private Q_SLOTS:
         QUrl sciFileUrl = QUrl::fromLocalFile("./test.sci");
 
         unsigned int initialNumberOfSciFiles = numberOfTemporarySciFiles();
+        UCUnits::instance()->setGridUnit(9);
 
         image1->setSource(sciFileUrl);
-        QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles + 1);
+        const QUrl rewrittenUrl = baseImage.source();
+        QCOMPARE(rewrittenUrl.scheme(), QString("data"));
+        QVERIFY(rewrittenUrl.path().endsWith("sci"));
+        QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles);
 
         image2->setSource(sciFileUrl);
-        QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles + 1);
+        QCOMPARE(baseImage.source(), rewrittenUrl);
+        QCOMPARE(image2->s_rewrittenSciUrls.count(), 1);
 
-        delete image1;
-        QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles + 1);
+        // The rewritten file follows grid unit changes.
+        UCUnits::instance()->setGridUnit(36);
+        image2->reloadSource();
+        QVERIFY(baseImage.source() != rewrittenUrl);
+        QCOMPARE(image2->s_rewrittenSciUrls.count(), 2);
+        QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles);
 
-        /* The temporary files will be deleted when the cache is destroyed when
-           the application exits.
-        */
+        delete image1;
         delete image2;
-        QCOMPARE(numberOfTemporarySciFiles(), initialNumberOfSciFiles + 1);
+    }
+
+    void rewrittenSciDataUrl() {
+        UCQQuickImageExtension image;
+        QString result;
+        QTextStream resultStream(&result);
+        QVERIFY(image.rewriteSciFile("test@18.sci", "0.5", resultStream));
+        resultStream.flush();
+
+        // The data URL decodes back to the rewritten file.
+        const QUrl url = image.sciDataUrl(result);
+        const QString encoded = url.toString(QUrl::FullyEncoded);
+        const QString data = QString::fromUtf8(QByteArray::fromPercentEncoding(
+            encoded.mid(encoded.indexOf(',') + 1).toLatin1()));
+        QCOMPARE(data, result + "#sci");
+        QVERIFY(data.contains("border.left: 5"));
     }
 };
 
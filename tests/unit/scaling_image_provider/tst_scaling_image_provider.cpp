@@ -17,16 +17,49 @@
  */
 
 #include <QtTest/QtTest>
+#include <UbuntuToolkit/private/ucasyncimageprovider_p.h>
 #include <UbuntuToolkit/private/ucscalingimageprovider_p.h>
 
 UT_USE_NAMESPACE
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+// Image provider blocking until the semaphore is released.
+class BlockingImageProvider : public QQuickImageProvider
+{
+public:
+    BlockingImageProvider() : QQuickImageProvider(QQuickImageProvider::Image) {}
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override {
+        Q_UNUSED(requestedSize);
+        lastId = id;
+        requestCount.ref();
+        semaphore.acquire();
+        if (id == "invalid") {
+            return QImage();
+        }
+        QImage image(4, 4, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        *size = image.size();
+        return image;
+    }
+
+    QSemaphore semaphore;
+    QAtomicInt requestCount;
+    QString lastId;
+};
+#endif
+
 class tst_UCScalingImageProvider: public QObject
 {
     Q_OBJECT
 
 private Q_SLOTS:
 
+    void initTestCase() {
+        // Keep the default disk cache out of the user's cache directory.
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
     void scaleToHalfSize() {
         UCScalingImageProvider provider;
         QImage result;
@@ -93,6 +126,110 @@ private Q_SLOTS:
         QCOMPARE(size, returnedSize);
         QCOMPARE(result.size(), resultSize);
     }
+
+    void diskCache() {
+        QTemporaryDir cacheDir;
+        QVERIFY(cacheDir.isValid());
+        const QString id = "0.5/" + QDir::currentPath() + QDir::separator() + "input.png";
+        QSize returnedSize;
+        QImage result;
+
+        UCScalingImageProvider provider;
+        provider.setDiskCachePath(cacheDir.path());
+        result = provider.requestImage(id, &returnedSize, QSize());
+        QVERIFY(!result.isNull());
+        QCOMPARE(QDir(cacheDir.path()).entryList(QDir::Files).count(), 1);
+
+        // A new provider doesn't share the memory cache and loads from disk.
+        UCScalingImageProvider cachedProvider;
+        cachedProvider.setDiskCachePath(cacheDir.path());
+        QSize cachedSize;
+        QImage cachedResult = cachedProvider.requestImage(id, &cachedSize, QSize());
+        QCOMPARE(cachedResult.convertToFormat(QImage::Format_ARGB32),
+                 result.convertToFormat(QImage::Format_ARGB32));
+        QCOMPARE(cachedSize, returnedSize);
+
+        // Entries are evicted once the cache gets above its maximum size.
+        cachedProvider.setDiskCacheMaxSize(0);
+        cachedProvider.requestImage("0.5/" + QDir::currentPath() + QDir::separator()
+                                    + "input.png", &cachedSize, QSize(10, 10));
+        QCOMPARE(QDir(cacheDir.path()).entryList(QDir::Files).count(), 0);
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+    void asyncProvider() {
+        BlockingImageProvider *blockingProvider = new BlockingImageProvider;
+        UCAsyncImageProvider provider(blockingProvider, 1);
+
+        // Identical requests are coalesced and all the responses finish.
+        QScopedPointer<QQuickImageResponse> response1(provider.requestImageResponse("a", QSize()));
+        QScopedPointer<QQuickImageResponse> response2(provider.requestImageResponse("a", QSize()));
+        QSignalSpy finished1(response1.data(), SIGNAL(finished()));
+        QSignalSpy finished2(response2.data(), SIGNAL(finished()));
+        blockingProvider->semaphore.release();
+        QTRY_COMPARE(finished1.count(), 1);
+        QTRY_COMPARE(finished2.count(), 1);
+        QCOMPARE(blockingProvider->requestCount.load(), 1);
+        QVERIFY(response1->errorString().isEmpty());
+        QScopedPointer<QQuickTextureFactory> factory(response2->textureFactory());
+        QCOMPARE(factory->textureSize(), QSize(4, 4));
+
+        // Most recent requests run first, cancelled requests aren't decoded
+        // if they didn't start yet.
+        QScopedPointer<QQuickImageResponse> response3(provider.requestImageResponse("b", QSize()));
+        QTRY_COMPARE(blockingProvider->requestCount.load(), 2);
+        QScopedPointer<QQuickImageResponse> response4(provider.requestImageResponse("c", QSize()));
+        QScopedPointer<QQuickImageResponse> response5(provider.requestImageResponse("d", QSize()));
+        QSignalSpy finished3(response3.data(), SIGNAL(finished()));
+        QSignalSpy finished4(response4.data(), SIGNAL(finished()));
+        QSignalSpy finished5(response5.data(), SIGNAL(finished()));
+        response4->cancel();
+        blockingProvider->semaphore.release();
+        QTRY_COMPARE(finished3.count(), 1);
+        QTRY_COMPARE(blockingProvider->requestCount.load(), 3);
+        QCOMPARE(blockingProvider->lastId, QString("d"));
+        blockingProvider->semaphore.release();
+        QTRY_COMPARE(finished5.count(), 1);
+        QTest::qWait(50);
+        QCOMPARE(finished4.count(), 0);
+        QCOMPARE(blockingProvider->requestCount.load(), 3);
+
+        // Errors are reported for images that can't be loaded.
+        QScopedPointer<QQuickImageResponse> response6(
+            provider.requestImageResponse("invalid", QSize()));
+        QSignalSpy finished6(response6.data(), SIGNAL(finished()));
+        blockingProvider->semaphore.release();
+        QTRY_COMPARE(finished6.count(), 1);
+        QVERIFY(!response6->errorString().isEmpty());
+    }
+
+    void asyncProviderDestroyedBeforeResponse() {
+        BlockingImageProvider *blockingProvider = new BlockingImageProvider;
+        QScopedPointer<UCAsyncImageProvider> provider(
+            new UCAsyncImageProvider(blockingProvider, 1));
+
+        // A finished response outliving its provider must not touch it.
+        QScopedPointer<QQuickImageResponse> finishedResponse(
+            provider->requestImageResponse("a", QSize()));
+        QSignalSpy finished(finishedResponse.data(), SIGNAL(finished()));
+        blockingProvider->semaphore.release();
+        QTRY_COMPARE(finished.count(), 1);
+
+        // Neither must a pending one, failed when the provider is destroyed.
+        QScopedPointer<QQuickImageResponse> pendingResponse(
+            provider->requestImageResponse("b", QSize()));
+        QSignalSpy pendingFinished(pendingResponse.data(), SIGNAL(finished()));
+        QTRY_COMPARE(blockingProvider->requestCount.load(), 2);
+        blockingProvider->semaphore.release();
+        provider.reset();
+        QCOMPARE(pendingFinished.count(), 1);
+
+        pendingResponse->cancel();
+        finishedResponse->cancel();
+        pendingResponse.reset();
+        finishedResponse.reset();
+    }
+#endif
 };
 
 QTEST_MAIN(tst_UCScalingImageProvider)
@@ -2,6 +2,9 @@ include(../test-include-x11.pri)
 QT += core-private qml-private quick-private gui-private
 SOURCES += tst_subtheming.cpp
 
+DEFINES += THEME_BUNDLE_PATH='\\"$${ROOT_BUILD_DIR}/src/imports/Components/Themes\\"'
+DEFINES += THEME_SOURCE_PATH='\\"$${ROOT_SOURCE_DIR}/src/imports/Components/Themes\\"'
+
 OTHER_FILES += \
     TestStyle.qml \
     SimpleItem.qml \
@@ -45,6 +48,8 @@ OTHER_FILES += \
     OverrideStyleHints.qml \
     HintedButton.qml \
     OtherVersion.qml \
+    DeferredStyle.qml \
+    ThemeSwitch.qml \
     DefaultTheme.qml \
     themes/DerivedTheme/parent_theme \
     themes/DerivedTheme/1.2/TestStyle.qml \
@@ -104,6 +104,7 @@ private Q_SLOTS:
         qputenv("UBUNTU_UI_TOOLKIT_THEMES_PATH", m_themesPath.toLatin1());
         qputenv("XDG_DATA_DIRS", m_xdgDataPath.toLocal8Bit());
         UCTheme::previousVersion = 0;
+        UCStyledItemBasePrivate::deferStyles = false;
     }
 
     void test_default_theme()
@@ -217,6 +218,33 @@ private Q_SLOTS:
         QCOMPARE(testStyle != NULL, success);
     }
 
+    void test_shared_style_component()
+    {
+        qputenv("UBUNTU_UI_TOOLKIT_THEMES_PATH", "./themes");
+
+        QScopedPointer<ThemeTestCase> view(new ThemeTestCase("SimpleItem.qml"));
+        view->setTheme("TestModule.TestTheme", view->rootObject());
+        view->rootObject()->setProperty("styleName", "TestStyle");
+        UCTheme *theme = view->theme();
+        QVERIFY(theme);
+        QQmlComponent *component =
+            theme->styleComponent("TestStyle.qml", view->rootObject(), BUILD_VERSION(1, 3));
+        QVERIFY(component);
+        // the style item has been created from the cached component
+        QCOMPARE(theme->m_styleComponents.count(), 1);
+        QCOMPARE(theme->styleComponent("TestStyle.qml", view->rootObject(), BUILD_VERSION(1, 3)),
+                 component);
+        QVERIFY(!QQmlEngine::contextForObject(component));
+
+        // the cache is dropped when the theme changes
+        view->setTheme("CustomTheme", view->rootObject());
+        QVERIFY(view->rootObject()->findChild<QQuickItem*>("TestStyle"));
+        QCOMPARE(theme->m_styleComponents.count(), 1);
+        component =
+            theme->styleComponent("TestStyle.qml", view->rootObject(), BUILD_VERSION(1, 3));
+        QVERIFY(component->url().toString().endsWith("CustomTheme/1.3/TestStyle.qml"));
+    }
+
     void test_relative_theme_paths_environment_variables_data()
     {
         QTest::addColumn<QString>("themePath");
@@ -753,6 +781,51 @@ private Q_SLOTS:
         QScopedPointer<ThemeTestCase> view(new ThemeTestCase("DeprecatedTheme.qml"));
     }
 
+    void test_theme_bundles_data()
+    {
+        QTest::addColumn<QString>("theme");
+
+        QTest::newRow("Ambiance") << "Ambiance";
+        QTest::newRow("SuruDark") << "SuruDark";
+        QTest::newRow("SuruGradient") << "SuruGradient";
+    }
+    void test_theme_bundles()
+    {
+        QFETCH(QString, theme);
+
+        // install the toolkit themes as bundles only, without the loose files
+        QTemporaryDir themesPath;
+        QVERIFY(themesPath.isValid());
+        const QStringList themes = QStringList() << "Ambiance" << "SuruDark" << "SuruGradient";
+        Q_FOREACH(const QString &name, themes) {
+            const QString bundle = QStringLiteral(THEME_BUNDLE_PATH "/%1/theme.rcc").arg(name);
+            if (!QFile::exists(bundle)) {
+                QSKIP("The theme bundles are not built");
+            }
+            const QString folder = themesPath.path() + "/Ubuntu/Components/Themes/" + name;
+            QVERIFY(QDir().mkpath(folder));
+            QVERIFY(QFile::copy(bundle, folder + "/theme.rcc"));
+            QVERIFY(QFile::copy(QStringLiteral(THEME_SOURCE_PATH "/%1/qmldir").arg(name), folder + "/qmldir"));
+        }
+        qputenv("UBUNTU_UI_TOOLKIT_THEMES_PATH", themesPath.path().toLocal8Bit());
+
+        QScopedPointer<ThemeTestCase> view(new ThemeTestCase("SimpleItem.qml"));
+        view->setTheme("Ubuntu.Components.Themes." + theme, view->rootObject());
+        UCTheme *itemTheme = view->theme();
+        QVERIFY(itemTheme);
+        QVERIFY(!itemTheme->m_themePaths.isEmpty());
+        Q_FOREACH(const UCTheme::ThemeRecord &record, itemTheme->m_themePaths) {
+            QCOMPARE(record.path.scheme(), QString("qrc"));
+        }
+        // the style imports its parent theme, which fails if the import is
+        // resolved to the folder holding no loose files
+        QQmlComponent *component =
+            itemTheme->styleComponent("OptionSelectorStyle.qml", view->rootObject(), BUILD_VERSION(1, 3));
+        QVERIFY(component);
+        QVERIFY2(component->isReady(), qPrintable(component->errorString()));
+        QCOMPARE(component->url().scheme(), QString("qrc"));
+    }
+
     void test_style_change_has_precedence()
     {
         QScopedPointer<ThemeTestCase> view(new ThemeTestCase("StyleOverride.qml"));
@@ -787,8 +860,13 @@ private Q_SLOTS:
         UCTheme *theme = button->property("theme").value<UCTheme*>();
         QVERIFY(theme);
 
+        QPointer<QQuickItem> oldStyle(button->findChild<QQuickItem*>("TestStyle"));
+        QVERIFY(oldStyle);
         theme->setName("Ubuntu.Components.Themes.SuruDark");
         QVERIFY(button->findChild<QQuickItem*>("TestStyle"));
+        // the explicit style is recreated on theme changes
+        QTRY_VERIFY(!oldStyle);
+        QVERIFY(button->findChild<QQuickItem*>("TestStyle"));
     }
 
     void test_style_reset_to_theme_style()
@@ -929,6 +1007,72 @@ private Q_SLOTS:
         QUrl style = theme->styleUrl("TestStyle.qml", BUILD_VERSION(1, 3), &fallback);
         QVERIFY(style.toString().endsWith("TestTheme/1.3/TestStyle.qml"));
     }
+
+    void test_deferred_style()
+    {
+        qputenv("UBUNTU_UI_TOOLKIT_THEMES_PATH", "./themes");
+        UCStyledItemBasePrivate::deferStyles = true;
+
+        QScopedPointer<ThemeTestCase> view(new ThemeTestCase("DeferredStyle.qml"));
+        UCStyledItemBase *shown = view->findItem<UCStyledItemBase*>("shown");
+        UCStyledItemBase *deferred = view->findItem<UCStyledItemBase*>("deferred");
+        UCStyledItemBase *queried = view->findItem<UCStyledItemBase*>("queried");
+        QVERIFY(UCStyledItemBasePrivate::get(shown)->styleItem);
+        QVERIFY(!UCStyledItemBasePrivate::get(deferred)->styleItem);
+        QVERIFY(!UCStyledItemBasePrivate::get(queried)->styleItem);
+
+        // querying the style instance creates it
+        QVERIFY(queried->property("__styleInstance").value<QQuickItem*>());
+        QVERIFY(!UCStyledItemBasePrivate::get(deferred)->styleItem);
+
+        // showing the hidden ancestor creates it
+        view->rootObject()->setProperty("hiddenVisible", true);
+        QVERIFY(UCStyledItemBasePrivate::get(deferred)->styleItem);
+    }
+
+    void test_style_reused_on_theme_change()
+    {
+        QScopedPointer<ThemeTestCase> view(new ThemeTestCase("ThemeSwitch.qml"));
+        UCStyledItemBasePrivate *reused =
+                UCStyledItemBasePrivate::get(view->findItem<UCStyledItemBase*>("reused"));
+        UCStyledItemBasePrivate *reloaded =
+                UCStyledItemBasePrivate::get(view->findItem<UCStyledItemBase*>("reloaded"));
+        QQuickItem *reusedStyle = reused->styleItem;
+        QVERIFY(reusedStyle);
+        QVERIFY(reloaded->styleItem);
+
+        view->rootObject()->setProperty("themeName", "Ubuntu.Components.Themes.SuruDark");
+        // SuruDark has no ButtonStyle, the one of Ambiance is kept
+        QCOMPARE(reused->styleItem, reusedStyle);
+        // the OptionSelectorStyle of SuruDark is incubated then replaces the Ambiance one
+        QTRY_VERIFY(reloaded->styleItemUrl.toString().endsWith(
+                        "SuruDark/1.3/OptionSelectorStyle.qml"));
+        QVERIFY(reloaded->styleItem);
+        QCOMPARE(reloaded->styleItem->parentItem(), view->findItem<QQuickItem*>("reloaded"));
+    }
+
+    void test_style_url_memoized() {
+        qputenv("UBUNTU_UI_TOOLKIT_THEMES_PATH", "");
+        qputenv("XDG_DATA_DIRS", "./themes:./themes/TestModule");
+
+        QScopedPointer<UCTheme> theme(new UCTheme);
+        theme->setName("DerivedTheme");
+
+        bool fallback = true;
+        QUrl style = theme->styleUrl("TestStyle.qml", BUILD_VERSION(1, 3), &fallback);
+        QVERIFY(style.toString().endsWith("TestTheme/1.3/TestStyle.qml"));
+        QVERIFY(!fallback);
+        QVERIFY(!theme->styleUrl("NotExistingStyle.qml", BUILD_VERSION(1, 3)).isValid());
+        QCOMPARE(theme->m_styleUrls.count(), 2);
+        QCOMPARE(theme->styleUrl("TestStyle.qml", BUILD_VERSION(1, 3)), style);
+        QCOMPARE(theme->m_styleUrls.count(), 2);
+
+        // the table is rebuilt with the new theme paths
+        theme->setName("CustomTheme");
+        QCOMPARE(theme->m_styleUrls.count(), 0);
+        style = theme->styleUrl("TestStyle.qml", BUILD_VERSION(1, 3));
+        QVERIFY(style.toString().endsWith("CustomTheme/1.3/TestStyle.qml"));
+    }
 };
 
 QTEST_MAIN(tst_Subtheming)
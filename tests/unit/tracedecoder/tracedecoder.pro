@@ -0,0 +1,4 @@
+include(../test-include.pri)
+QT += UbuntuMetrics UbuntuMetrics-private
+SOURCES += tst_tracedecoder.cpp
+DEFINES += TRACEDECODER_PATH=\\\"$$ROOT_BUILD_DIR/src/UbuntuMetrics/tools/tracedecoder/umtracedecoder\\\"
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtCore/QFile>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+#include <UbuntuMetrics/events.h>
+#include <UbuntuMetrics/logger.h>
+#include <UbuntuMetrics/private/logger_p.h>
+
+class tst_TraceDecoder : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    QString writeTrace(const QString& name)
+    {
+        const QString fileName = m_dir.path() + QLatin1Char('/') + name;
+        UMFileLogger logger(fileName, UMFileLogger::Binary);
+        if (!logger.isOpen()) {
+            return QString();
+        }
+
+        UMEvent event;
+        memset(&event, 0, sizeof(event));
+        event.type = UMEvent::Process;
+        event.timeStamp = 1000;
+        event.process.cpuUsage = 42;
+        event.process.threadCount = 7;
+        logger.log(event);
+
+        memset(&event, 0, sizeof(event));
+        event.type = UMEvent::Frame;
+        event.timeStamp = 2000;
+        event.frame.window = 1;
+        event.frame.number = 3;
+        event.frame.renderTime = 4000000;
+        logger.log(event);
+
+        memset(&event, 0, sizeof(event));
+        event.type = UMEvent::Generic;
+        event.timeStamp = 3000;
+        event.generic.id = 2;
+        qstrcpy(event.generic.string, "a \"quoted\" string");
+        event.generic.stringSize = qstrlen(event.generic.string) + 1;
+        logger.log(event);
+
+        // The events are written when the logger is destroyed.
+        return fileName;
+    }
+
+    // Runs the decoder and returns its output, or an empty array on failure.
+    QByteArray decode(const QStringList& arguments)
+    {
+        QProcess decoder;
+        decoder.start(QStringLiteral(TRACEDECODER_PATH), arguments);
+        if (!decoder.waitForFinished() || decoder.exitStatus() != QProcess::NormalExit
+            || decoder.exitCode() != 0) {
+            return QByteArray();
+        }
+        return decoder.readAllStandardOutput();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        if (!QFile::exists(QStringLiteral(TRACEDECODER_PATH))) {
+            QSKIP("umtracedecoder isn't built.");
+        }
+    }
+
+    void test_header()
+    {
+        const QString fileName = writeTrace(QStringLiteral("header.umt"));
+        QVERIFY(!fileName.isEmpty());
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.size(), qint64(sizeof(UMBinaryTraceHeader) + 3 * sizeof(UMEvent)));
+
+        UMBinaryTraceHeader header;
+        QCOMPARE(file.read(reinterpret_cast<char*>(&header), sizeof(header)),
+                 qint64(sizeof(header)));
+        QCOMPARE(QByteArray(header.magic), QByteArray("UMTRACE"));
+        QCOMPARE(header.version, UMBinaryTraceHeader::currentVersion);
+        QCOMPARE(header.eventSize, quint32(sizeof(UMEvent)));
+        QCOMPARE(header.byteOrder, UMBinaryTraceHeader::byteOrderMark);
+    }
+
+    void test_decode_csv()
+    {
+        const QString fileName = writeTrace(QStringLiteral("csv.umt"));
+        QVERIFY(!fileName.isEmpty());
+        const QByteArray output = decode(QStringList() << "-f" << "csv" << fileName);
+        const QList<QByteArray> lines = output.trimmed().split('\n');
+        QCOMPARE(lines.size(), 4);
+        // The rows must have the same number of columns as the header.
+        const int columnCount = lines[0].count(',');
+        QCOMPARE(lines[1].count(','), columnCount);
+        QCOMPARE(lines[2].count(','), columnCount);
+        QVERIFY(lines[1].startsWith("P,1000,"));
+        QVERIFY(lines[2].startsWith("F,2000,1,,,,3,"));
+        QVERIFY(lines[3].startsWith("G,3000,2,"));
+        QVERIFY(lines[3].endsWith("\"a \"\"quoted\"\" string\""));
+    }
+
+    void test_decode_parsable()
+    {
+        const QString fileName = writeTrace(QStringLiteral("parsable.umt"));
+        QVERIFY(!fileName.isEmpty());
+        const QByteArray output = decode(QStringList() << fileName);
+        QCOMPARE(output.trimmed().split('\n').size(), 3);
+    }
+
+    void test_version_mismatch()
+    {
+        const QString fileName = writeTrace(QStringLiteral("version.umt"));
+        QVERIFY(!fileName.isEmpty());
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        const quint32 version = UMBinaryTraceHeader::currentVersion - 1;
+        QVERIFY(file.seek(offsetof(UMBinaryTraceHeader, version)));
+        QCOMPARE(file.write(reinterpret_cast<const char*>(&version), sizeof(version)),
+                 qint64(sizeof(version)));
+        file.close();
+
+        QProcess decoder;
+        decoder.start(QStringLiteral(TRACEDECODER_PATH), QStringList() << fileName);
+        QVERIFY(decoder.waitForFinished());
+        QCOMPARE(decoder.exitCode(), 1);
+        QVERIFY(decoder.readAllStandardOutput().isEmpty());
+    }
+};
+
+QTEST_MAIN(tst_TraceDecoder)
+
+#include "tst_tracedecoder.moc"
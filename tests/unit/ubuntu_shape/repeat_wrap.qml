@@ -0,0 +1,40 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.4
+import Ubuntu.Components 1.3
+
+// An opaque 8x8 source made of 4x4 green and blue squares, padded at the
+// top-left of the shape and only repeated horizontally. Small enough to be in a
+// texture atlas, unless mipmapped.
+UbuntuShape {
+    property bool mipmap: false
+
+    width: 200
+    height: 200
+    aspect: UbuntuShape.Flat
+    backgroundColor: "red"
+    source: Image {
+        source: "repeat_wrap_source.png"
+        mipmap: parent.mipmap
+        visible: false
+    }
+    sourceFillMode: UbuntuShape.Pad
+    sourceHorizontalAlignment: UbuntuShape.AlignLeft
+    sourceVerticalAlignment: UbuntuShape.AlignTop
+    sourceHorizontalWrapMode: UbuntuShape.Repeat
+    sourceVerticalWrapMode: UbuntuShape.Transparent
+}
@@ -19,6 +19,30 @@
 #include <QtQml/QQmlEngine>
 #include <QtQuick/QQuickView>
 #include <QtTest/QtTest>
+#include <UbuntuToolkit/private/ucubuntushapetextures_p.h>
+
+UT_USE_NAMESPACE
+
+// Compares generated texture data to the data baked by the former createshapetextures tool,
+// tolerating a difference of 1 for floating-point differences between architectures.
+static bool compareTextureData(const quint8* data, const char* expected, int size, int* offset)
+{
+    for (int i = 0; i < size; i++) {
+        if (qAbs(data[i] - static_cast<quint8>(expected[i])) > 1) {
+            *offset = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compares a rendered pixel to the expected color, tolerating rounding errors in the sampling.
+static bool compareColor(QRgb pixel, Qt::GlobalColor expected)
+{
+    const QRgb color = QColor(expected).rgb();
+    return qAbs(qRed(pixel) - qRed(color)) <= 2 && qAbs(qGreen(pixel) - qGreen(color)) <= 2
+        && qAbs(qBlue(pixel) - qBlue(color)) <= 2;
+}
 
 class tst_UbuntuShape: public QObject
 {
@@ -31,6 +55,15 @@ private Q_SLOTS:
 
     void initTestCase()
     {
+        // Keep the generated textures out of the user's cache directory and remove the ones
+        // cached by previous runs so that they are generated.
+        QStandardPaths::setTestModeEnabled(true);
+        const QString cacheDir =
+            QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/ubuntu-ui-toolkit/";
+        QFile::remove(cacheDir + "shapetextures-distancefield");
+        QFile::remove(cacheDir + "shapetextures-mipmap");
+
         m_quickView = new QQuickView;
         m_quickView->setGeometry(0, 0, 900, 500);
         m_quickView->show();
@@ -56,6 +89,69 @@ private Q_SLOTS:
 
         QCOMPARE(result, expected);
     }
+
+    void repeatWrapMode_data() {
+        QTest::addColumn<bool>("mipmap");
+
+        // Emulated in the shaders for sources in an atlas, GL_REPEAT for mipmapped ones.
+        QTest::newRow("atlas") << false;
+        QTest::newRow("mipmapped") << true;
+    }
+    void repeatWrapMode() {
+        QFETCH(bool, mipmap);
+
+        m_quickView->setSource(QUrl::fromLocalFile("repeat_wrap.qml"));
+        QVERIFY(QTest::qWaitForWindowExposed(m_quickView));
+        if (!m_quickView->openglContext()) {
+            QSKIP("Requires working OpenGL");
+        }
+        m_quickView->rootObject()->setProperty("mipmap", mipmap);
+        const QImage result = m_quickView->grabWindow();
+        QVERIFY(!result.isNull());
+
+        // The source is mapped 1:1 over several periods, a shifted or stretched repeat blends
+        // the squares and seams blend in the texels around the source in its atlas.
+        for (int x = 40; x < 160; x++) {
+            for (int y = 1; y < 7; y++) {
+                const bool green = ((x % 8) / 4 + y / 4) % 2 == 0;
+                QVERIFY2(compareColor(result.pixel(x, y), green ? Qt::green : Qt::blue),
+                         qPrintable(QString("Wrong color at %1,%2").arg(x).arg(y)));
+            }
+        }
+        // The source isn't wrapped on the axis with the transparent wrap mode.
+        for (int x = 40; x < 160; x++) {
+            for (int y = 20; y < 180; y += 20) {
+                QCOMPARE(QColor(result.pixel(x, y)), QColor(Qt::red));
+            }
+        }
+    }
+
+    void generatedTextures() {
+        // The golden file holds the textures baked by the former createshapetextures tool: both
+        // distance field textures followed by both mipmap textures, compressed with qCompress().
+        QFile golden("shapetextures.golden");
+        QVERIFY(golden.open(QIODevice::ReadOnly));
+        const QByteArray expected = qUncompress(golden.readAll());
+        const int textureSize = shapeTextureWidth * shapeTextureHeight * 4;
+        int mipmapSize = 0;
+        for (int i = 0; i < shapeTextureMipmapCount; i++) {
+            mipmapSize += (shapeTextureMipmapWidth >> i) * (shapeTextureMipmapHeight >> i) * 4;
+        }
+        QCOMPARE(expected.size(), shapeTextureCount * (textureSize + mipmapSize));
+
+        int offset;
+        for (int i = 0; i < shapeTextureCount; i++) {
+            QVERIFY2(compareTextureData(shapeTextureData(i), expected.constData() + i * textureSize,
+                                        textureSize, &offset),
+                     qPrintable(QString("Texture %1 differs at byte %2").arg(i).arg(offset)));
+        }
+        const char* expectedMipmaps = expected.constData() + shapeTextureCount * textureSize;
+        for (int i = 0; i < shapeTextureCount; i++) {
+            QVERIFY2(compareTextureData(shapeTextureMipmapData(i),
+                                        expectedMipmaps + i * mipmapSize, mipmapSize, &offset),
+                     qPrintable(QString("Mipmap texture %1 differs at byte %2").arg(i).arg(offset)));
+        }
+    }
 };
 
 QTEST_MAIN(tst_UbuntuShape)
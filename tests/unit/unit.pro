@@ -39,6 +39,10 @@ SUBDIRS += \
     scaling_image_provider \
     qquick_image_extension \
     performance \
+    frame_benchmark \
+    tracedecoder \
+    drawcall_benchmark \
+    programbinarycache \
     mainview \
     i18n \
     arguments \
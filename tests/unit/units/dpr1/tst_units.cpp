@@ -282,6 +282,58 @@ private Q_SLOTS:
         expected = QString("0.875/" + QDir::currentPath() + QDir::separator() + "resource@8.png");
         QCOMPARE(resolved, expected);
     }
+
+    void resolveCacheInvalidation() {
+        UCUnits units;
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(QFile::copy("resource@8.png", dir.path() + "/asset@8.png"));
+        const QUrl url = QUrl::fromLocalFile(dir.path() + "/asset.png");
+
+        units.setGridUnit(10);
+        QCOMPARE(units.resolveResource(url), QString("1.25/" + dir.path() + "/asset@8.png"));
+
+        // Resolutions are updated when the grid unit changes.
+        units.setGridUnit(8);
+        QCOMPARE(units.resolveResource(url), QString("1/" + dir.path() + "/asset@8.png"));
+
+        // and when an asset is added to the directory.
+        units.setGridUnit(10);
+        QVERIFY(QFile::copy("resource@10.png", dir.path() + "/asset@10.png"));
+        QTRY_COMPARE(units.resolveResource(url), QString("1/" + dir.path() + "/asset@10.png"));
+    }
+
+    void resolveHiddenFile() {
+        UCUnits units;
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(QFile::copy("resource@8.png", dir.path() + "/.asset@8.png"));
+
+        units.setGridUnit(8);
+        QCOMPARE(units.resolveResource(QUrl::fromLocalFile(dir.path() + "/.asset.png")),
+                 QString("1/" + dir.path() + "/.asset@8.png"));
+    }
+
+    void resolveManyDirectories() {
+        UCUnits units;
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        units.setGridUnit(10);
+
+        // Resolutions are still updated after going through more directories
+        // than indexed at once.
+        for (int i = 0; i < 100; ++i) {
+            const QString path = dir.path() + "/" + QString::number(i);
+            QVERIFY(QDir().mkdir(path));
+            QVERIFY(QFile::copy("resource@8.png", path + "/asset@8.png"));
+            QCOMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/asset.png")),
+                     QString("1.25/" + path + "/asset@8.png"));
+        }
+        const QString path = dir.path() + "/99";
+        QVERIFY(QFile::copy("resource@10.png", path + "/asset@10.png"));
+        QTRY_COMPARE(units.resolveResource(QUrl::fromLocalFile(path + "/asset.png")),
+                     QString("1/" + path + "/asset@10.png"));
+    }
 };
 
 QTEST_MAIN(tst_UCUnits)
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2016 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+import QtQuick 2.4
+import QtTest 1.0
+import Ubuntu.Components 1.3
+
+Item {
+    id: root
+    width: units.gu(40)
+    height: units.gu(40)
+
+    Component {
+        id: imageComponent
+        Image {
+            asynchronous: false
+        }
+    }
+
+    TestCase {
+        name: "ImageProviders"
+        when: windowShown
+
+        // logo.png is 84x24.
+        function logoPath() {
+            return Qt.resolvedUrl("logo.png").toString().replace("file://", "");
+        }
+
+        function test_scaling_provider_is_synchronous() {
+            var image = imageComponent.createObject(root, {
+                "source": "image://scaling/0.5/" + logoPath()
+            });
+            verify(image);
+            // Synchronous images are loaded by the time they are created.
+            compare(image.status, Image.Ready);
+            compare(image.sourceSize.width, 42);
+            compare(image.sourceSize.height, 12);
+            image.destroy();
+        }
+    }
+}
@@ -34,6 +34,7 @@
 #include <QtCore/QCommandLineParser>
 #include <QtCore/QCommandLineOption>
 #include <UbuntuToolkit/private/mousetouchadaptor_p.h>
+#include <UbuntuToolkit/private/unixsignalhandler_p.h>
 #include <UbuntuMetrics/applicationmonitor.h>
 #include <QtGui/QTouchDevice>
 #include <QtQml/qqml.h>
@@ -77,11 +78,22 @@ int main(int argc, const char *argv[])
     QCommandLineOption _metricsOverlay("metrics-overlay", "Enable the metrics overlay");
     QCommandLineOption _metricsLogging(
         "metrics-logging", "Enable metrics logging, <device> can be 'stdout', 'lttng' (Linux "
-        "only), a local or absolute filename", "device");
+        "only), a local or absolute filename, or a filename prefixed by 'binary:' to write a "
+        "binary trace", "device");
+    QCommandLineOption _metricsFlightRecorder(
+        "metrics-flight-recorder", "Keep the last 10 seconds of metrics in memory and dump them "
+        "to <file>.<n> binary traces on SIGUSR2 or when a frame takes more than 32 ms",
+        "file");
+    QCommandLineOption _metricsFrameSummary(
+        "metrics-frame-summary", "Log frame time percentiles every <interval> ms instead of "
+        "every frame", "interval");
     QCommandLineOption _metricsLoggingFilter(
         "metrics-logging-filter", "Filter metrics logging, <filter> is a list of events separated "
-        "by a comma ('window', 'process', 'frame' or '*'), events not filtered are discarded",
-        "filter");
+        "by a comma ('window', 'process', 'frame', 'generic', 'thread' or '*'), events not "
+        "filtered are discarded", "filter");
+    QCommandLineOption _metricsThreadInterval(
+        "metrics-thread-interval", "Log the CPU usage of each thread every <interval> ms",
+        "interval");
 
     args.addOption(_import);
     args.addOption(_enableTouch);
@@ -91,7 +103,10 @@ int main(int argc, const char *argv[])
     args.addOption(_desktop_file_hint);
     args.addOption(_metricsOverlay);
     args.addOption(_metricsLogging);
+    args.addOption(_metricsFlightRecorder);
+    args.addOption(_metricsFrameSummary);
     args.addOption(_metricsLoggingFilter);
+    args.addOption(_metricsThreadInterval);
     args.addPositionalArgument("filename", "Document to be viewed");
     args.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
     args.addHelpOption();
@@ -230,10 +245,16 @@ int main(int argc, const char *argv[])
                 filter |= UMApplicationMonitor::FrameEvent;
             } else if (filterList[i] == "generic") {
                 filter |= UMApplicationMonitor::GenericEvent;
+            } else if (filterList[i] == "thread") {
+                filter |= UMApplicationMonitor::ThreadEvent;
             }
         }
         applicationMonitor->setLoggingFilter(filter);
     }
+    if (args.isSet(_metricsThreadInterval)) {
+        applicationMonitor->setUpdateInterval(
+            UMEvent::Thread, args.value(_metricsThreadInterval).toInt());
+    }
     if (args.isSet(_metricsLogging)) {
         UMLogger* logger;
         QString device = args.value(_metricsLogging);
@@ -243,9 +264,14 @@ int main(int argc, const char *argv[])
         } else if (device == "lttng") {
             logger = new UMLTTNGLogger();
 #endif  // defined(Q_OS_LINUX)
+        } else if (device.startsWith("binary:")) {
+            logger = new UMFileLogger(device.mid(7), UMFileLogger::Binary);
         } else {
             logger = new UMFileLogger(device);
         }
+        if (args.isSet(_metricsFrameSummary)) {
+            logger = new UMFrameSummaryLogger(logger, args.value(_metricsFrameSummary).toInt());
+        }
         if (logger->isOpen()) {
             applicationMonitor->installLogger(logger);
             applicationMonitor->setLogging(true);
@@ -253,6 +279,21 @@ int main(int argc, const char *argv[])
             delete logger;
         }
     }
+    if (args.isSet(_metricsFlightRecorder)) {
+        UMFlightRecorder* flightRecorder = new UMFlightRecorder(args.value(_metricsFlightRecorder));
+        flightRecorder->setJankThreshold(32);
+        UT_PREPEND_NAMESPACE(UnixSignalHandler)& signalHandler =
+            UT_PREPEND_NAMESPACE(UnixSignalHandler)::instance();
+        signalHandler.connectSignal(UT_PREPEND_NAMESPACE(UnixSignalHandler)::User2);
+        QObject::connect(&signalHandler, &UT_PREPEND_NAMESPACE(UnixSignalHandler)::signalTriggered,
+                         [flightRecorder](int type) {
+            if (type == UT_PREPEND_NAMESPACE(UnixSignalHandler)::User2) {
+                flightRecorder->requestDump();
+            }
+        });
+        applicationMonitor->installLogger(flightRecorder);
+        applicationMonitor->setLogging(true);
+    }
     if (args.isSet(_metricsOverlay)) {
         applicationMonitor->setOverlay(true);
     }